@@ -0,0 +1,406 @@
+#include <opencv2/opencv.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "priority_queue.h"
+#include "image_usage.h"
+#include "image.h"
+#include "logging.h"
+#include "config.h"
+#include "crowd.h"
+#include "movement_list.h"
+#include "common.h"
+#include "csv.h"
+#include "resample.h"
+#include "pyramid.h"
+#include "instrument.h"
+
+#define BENCH_MAX_VALUES 32
+#define BENCH_MAX_REPETITIONS 128
+#define BENCH_LINE_SIZE 4096
+
+// Etapes mesurées du pipeline
+enum bench_stage_e {
+    STAGE_IMAGE_READ,
+    STAGE_GREY,
+    STAGE_CANNY,
+    STAGE_CLOSING,
+    STAGE_ENVIRONMENT,
+    STAGE_ROUTING,
+    STAGE_COUNT
+};
+const char* bench_stage_names[STAGE_COUNT] = {
+    "image_read", "grey", "canny", "closing", "environment", "routing"
+};
+
+// Liste de valeurs d'une dimension de la matrice de scénarios
+struct bench_values_s {
+    int count;
+    char* values[BENCH_MAX_VALUES];
+};
+typedef struct bench_values_s bench_values_t;
+
+// Matrice de scénarios (produit cartésien de toutes les dimensions)
+struct bench_matrix_s {
+    bench_values_t images;
+    bench_values_t movements;
+    bench_values_t compression;
+    bench_values_t weight0;
+    bench_values_t alpha;
+    bench_values_t modulo;
+    bench_values_t backend;
+    int repetitions;
+};
+typedef struct bench_matrix_s bench_matrix_t;
+
+// Un scénario de la matrice
+struct bench_scenario_s {
+    const char* image;
+    const char* movements;
+    int compression;
+    int weight0;
+    int alpha;
+    int modulo;
+    const char* backend;
+};
+typedef struct bench_scenario_s bench_scenario_t;
+
+// Mesures d'une exécution (transmises par le processus fils)
+struct bench_sample_s {
+    bool ok;
+    double wall[STAGE_COUNT];   // Temps réel (secondes)
+    double cpu[STAGE_COUNT];    // Temps processeur (secondes)
+    double substages[INSTR_STAGE_COUNT];        // Temps réel cumulé par étape instrumentée (secondes)
+    long long counters[INSTR_COUNTER_COUNT];    // Compteurs de l'instrumentation
+    long peak_rss_kb;                           // Pic de mémoire résidente
+};
+typedef struct bench_sample_s bench_sample_t;
+
+// Noms des compteurs rapportés (ceux de l'instrumentation, puis le pic mémoire)
+const char* bench_counter_names[INSTR_COUNTER_COUNT + 1] = {
+    "expanded", "pushes", "pops", "paths", "path_cells", "heuristic_refreshes", "path_cache_hits",
+    "allocations", "allocated_bytes", "peak_rss_kb"
+};
+
+// Horloges
+double bench_clock(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+// Découper une liste de valeurs séparées par des ';'
+void bench_parse_values(bench_values_t* values, char* list) {
+    values->count = 0;
+    for (char* token = strtok(list, ";\n\r"); token != NULL && values->count < BENCH_MAX_VALUES;
+         token = strtok(NULL, ";\n\r")) {
+        while (*token == ' ') token++;
+        if (*token != '\0') values->values[values->count++] = strdup(token);
+    }
+}
+
+// Charger une matrice de scénarios (une dimension par ligne : cle=v1;v2;...)
+bench_matrix_t bench_load_matrix(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) log_fatal("Erreur lors de l'ouverture du fichier de scénarios : %s", filename);
+
+    bench_matrix_t matrix;
+    memset(&matrix, 0, sizeof(matrix));
+    matrix.repetitions = 5;
+    char one[] = "1";
+    char ten[] = "10";
+    char iterative[] = "iterative";
+    bench_parse_values(&matrix.compression, one);
+    bench_parse_values(&matrix.weight0, one);
+    bench_parse_values(&matrix.alpha, one);
+    bench_parse_values(&matrix.modulo, ten);
+    bench_parse_values(&matrix.backend, iterative);
+
+    char line[BENCH_LINE_SIZE];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char* separator = strchr(line, '=');
+        if (separator == NULL) continue;
+        *separator = '\0';
+        char* list = separator + 1;
+
+        if (strcmp(line, "images") == 0) bench_parse_values(&matrix.images, list);
+        else if (strcmp(line, "movements") == 0) bench_parse_values(&matrix.movements, list);
+        else if (strcmp(line, "compression") == 0) bench_parse_values(&matrix.compression, list);
+        else if (strcmp(line, "weight0") == 0) bench_parse_values(&matrix.weight0, list);
+        else if (strcmp(line, "alpha") == 0) bench_parse_values(&matrix.alpha, list);
+        else if (strcmp(line, "modulo") == 0) bench_parse_values(&matrix.modulo, list);
+        else if (strcmp(line, "backend") == 0) bench_parse_values(&matrix.backend, list);
+        else if (strcmp(line, "repetitions") == 0) matrix.repetitions = atoi(list);
+        else log_warning("Dimension inconnue dans %s : %s", filename, line);
+    }
+    fclose(file);
+
+    if (matrix.images.count == 0 || matrix.movements.count == 0) {
+        log_fatal("Le fichier de scénarios doit définir images= et movements=");
+    }
+    if (matrix.repetitions < 1 || matrix.repetitions > BENCH_MAX_REPETITIONS) {
+        log_fatal("Nombre de répétitions invalide (%d)", matrix.repetitions);
+    }
+    return matrix;
+}
+
+// Exécuter un scénario complet (dans le processus fils)
+bench_sample_t bench_run(bench_scenario_t scenario) {
+    bench_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    double wall = bench_clock(CLOCK_MONOTONIC);
+    double cpu = bench_clock(CLOCK_PROCESS_CPUTIME_ID);
+
+// Clore la mesure d'une étape
+#define BENCH_STAGE_END(stage) do { \
+        double w = bench_clock(CLOCK_MONOTONIC); \
+        double c = bench_clock(CLOCK_PROCESS_CPUTIME_ID); \
+        sample.wall[stage] = w - wall; \
+        sample.cpu[stage] = c - cpu; \
+        wall = w; \
+        cpu = c; \
+    } while (0)
+
+    int n = scenario.compression;
+    instrument_reset();
+    colored_image_t colored_image = image_read(scenario.image);
+    BENCH_STAGE_END(STAGE_IMAGE_READ);
+
+    image_t image = (n > 1) ? image_from_colored_image_resampled(colored_image, n)
+                            : image_from_colored_image(colored_image);
+    BENCH_STAGE_END(STAGE_GREY);
+
+    image_t canny_image = canny(image, 0.1, 0.2);
+    BENCH_STAGE_END(STAGE_CANNY);
+
+    image_t image_morpho = image_fermeture_morphologique(canny_image, 30/n);
+    BENCH_STAGE_END(STAGE_CLOSING);
+
+    environment_t env = env_from_image(image_morpho);
+    env_initialiser_tableaux(&env);
+    movement_list_t* movements = load_movements(scenario.movements, n);
+    if (movements == NULL) log_fatal("Erreur lors de la lecture des mouvements : %s", scenario.movements);
+    BENCH_STAGE_END(STAGE_ENVIRONMENT);
+
+    if (strcmp(scenario.backend, "pyramid") == 0) {
+        int levels = PYRAMID_LEVELS > 1 ? PYRAMID_LEVELS : 4;
+        multiple_move_env_pyramid_a_star(movements, &env, scenario.weight0, scenario.alpha, levels);
+    }
+    else if (strcmp(scenario.backend, "iterative") == 0) {
+        multiple_move_env_iterative_a_star(movements, &env, scenario.weight0, scenario.alpha, scenario.modulo);
+    }
+    else {
+        log_fatal("Moteur de routage inconnu : %s", scenario.backend);
+    }
+    BENCH_STAGE_END(STAGE_ROUTING);
+#undef BENCH_STAGE_END
+
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) {
+        sample.substages[s] = (double) instrument_stage_total(s) / 1e9;
+    }
+    for (int c = 0; c < INSTR_COUNTER_COUNT; c++) {
+        sample.counters[c] = instrument_counter(c);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    sample.peak_rss_kb = usage.ru_maxrss;
+    sample.ok = true;
+
+    free_movements(movements);
+    env_liberer_tableaux(&env);
+    env_free(env);
+    image_free(canny_image);
+    image_free(image_morpho);
+    image_free(image);
+    colored_image_free(colored_image);
+    return sample;
+}
+
+// Exécuter un scénario dans un processus fils (mémoire et tableaux globaux isolés)
+bench_sample_t bench_run_isolated(bench_scenario_t scenario) {
+    bench_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+
+    int fds[2];
+    if (pipe(fds) != 0) log_fatal("Erreur lors de la création d'un tube");
+    pid_t pid = fork();
+    if (pid < 0) log_fatal("Erreur lors de la création d'un processus");
+    if (pid == 0) {
+        close(fds[0]);
+        bench_sample_t result = bench_run(scenario);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        close(fds[1]);
+        _exit(written == (ssize_t) sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    if (read(fds[0], &sample, sizeof(sample)) != (ssize_t) sizeof(sample)) sample.ok = false;
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) sample.ok = false;
+    return sample;
+}
+
+// Comparer deux réels (pour qsort)
+int bench_compare(const void* a, const void* b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+// Calculer la médiane et le 95e centile d'une série
+void bench_stats(double* values, int count, double* median, double* p95) {
+    qsort(values, count, sizeof(double), bench_compare);
+    *median = (count % 2 == 1) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.;
+    int rank = (int) (0.95 * count + 0.999999) - 1; // Rang le plus proche
+    if (rank < 0) rank = 0;
+    *p95 = values[rank];
+}
+
+// Ecrire une chaîne JSON entre guillemets (guillemets, barres obliques inverses et caractères de contrôle
+// échappés)
+void bench_json_string(FILE* json, const char* text) {
+    fputc('"', json);
+    for (const unsigned char* c = (const unsigned char*) text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fprintf(json, "\\%c", *c);
+        else if (*c < 0x20) fprintf(json, "\\u%04x", *c);
+        else fputc(*c, json);
+    }
+    fputc('"', json);
+}
+
+// Ecrire les statistiques d'un scénario (une ligne CSV et un objet JSON)
+void bench_report(FILE* csv, FILE* json, bool first, bench_scenario_t scenario,
+                  bench_sample_t* samples, int count) {
+    double series[BENCH_MAX_REPETITIONS];
+    double median, p95;
+
+    fprintf(csv, "%s;%s;%d;%d;%d;%d;%s;%d", scenario.image, scenario.movements, scenario.compression,
+            scenario.weight0, scenario.alpha, scenario.modulo, scenario.backend, count);
+    fprintf(json, "%s\n  {\"image\": ", first ? "" : ",");
+    bench_json_string(json, scenario.image);
+    fprintf(json, ", \"movements\": ");
+    bench_json_string(json, scenario.movements);
+    fprintf(json, ", \"compression\": %d, \"weight0\": %d, \"alpha\": %d, \"modulo\": %d, \"backend\": ",
+            scenario.compression, scenario.weight0, scenario.alpha, scenario.modulo);
+    bench_json_string(json, scenario.backend);
+    fprintf(json, ", \"repetitions\": %d, \"stages\": {", count);
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        fprintf(json, "%s\"%s\": {", s == 0 ? "" : ", ", bench_stage_names[s]);
+        for (int kind = 0; kind < 2; kind++) {
+            for (int r = 0; r < count; r++) series[r] = kind == 0 ? samples[r].wall[s] : samples[r].cpu[s];
+            bench_stats(series, count, &median, &p95);
+            fprintf(csv, ";%.6f;%.6f", median, p95);
+            fprintf(json, "%s\"%s_median\": %.6f, \"%s_p95\": %.6f", kind == 0 ? "" : ", ",
+                    kind == 0 ? "wall" : "cpu", median, kind == 0 ? "wall" : "cpu", p95);
+        }
+        fprintf(json, "}");
+    }
+    fprintf(json, "}, \"substages\": {");
+
+    // Etapes instrumentées (sous-étapes de Canny, mouvements, recalculs de l'heuristique)
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) {
+        for (int r = 0; r < count; r++) series[r] = samples[r].substages[s];
+        bench_stats(series, count, &median, &p95);
+        fprintf(csv, ";%.6f", median);
+        fprintf(json, "%s\"%s_median\": %.6f", s == 0 ? "" : ", ", instrument_stage_name(s), median);
+    }
+    fprintf(json, "}");
+
+    // Compteurs (déterministes, la médiane suffit) et pic mémoire
+    for (int c = 0; c <= INSTR_COUNTER_COUNT; c++) {
+        for (int r = 0; r < count; r++) {
+            series[r] = c < INSTR_COUNTER_COUNT ? samples[r].counters[c] : samples[r].peak_rss_kb;
+        }
+        bench_stats(series, count, &median, &p95);
+        fprintf(csv, ";%.0f", median);
+        fprintf(json, ", \"%s\": %.0f", bench_counter_names[c], median);
+    }
+    fprintf(csv, "\n");
+    fprintf(json, "}");
+    fflush(csv);
+    fflush(json);
+}
+
+int main(int argc, char** argv) {
+    config_load("config.conf");
+
+    if (argc < 2 || 3 < argc) {
+        log_fatal("Usage : %s <fichier-scenarios> [prefixe-resultats]", argv[0]);
+    }
+    const char* prefix = (argc == 3) ? argv[2] : "bench_results";
+    bench_matrix_t m = bench_load_matrix(argv[1]);
+
+    char path[BENCH_LINE_SIZE];
+    snprintf(path, sizeof(path), "%s.csv", prefix);
+    FILE* csv = fopen(path, "w");
+    if (csv == NULL) log_fatal("Erreur lors de l'ouverture du fichier de résultats : %s", path);
+    snprintf(path, sizeof(path), "%s.json", prefix);
+    FILE* json = fopen(path, "w");
+    if (json == NULL) log_fatal("Erreur lors de l'ouverture du fichier de résultats : %s", path);
+
+    fprintf(csv, "image;movements;compression;weight0;alpha;modulo;backend;repetitions");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        fprintf(csv, ";%s_wall_median;%s_wall_p95;%s_cpu_median;%s_cpu_p95", bench_stage_names[s],
+                bench_stage_names[s], bench_stage_names[s], bench_stage_names[s]);
+    }
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) {
+        fprintf(csv, ";%s_median", instrument_stage_name(s));
+    }
+    for (int c = 0; c <= INSTR_COUNTER_COUNT; c++) {
+        fprintf(csv, ";%s", bench_counter_names[c]);
+    }
+    fprintf(csv, "\n");
+    fprintf(json, "[");
+
+    bench_sample_t samples[BENCH_MAX_REPETITIONS];
+    bool first = true;
+    for (int a = 0; a < m.images.count; a++)
+    for (int b = 0; b < m.movements.count; b++)
+    for (int c = 0; c < m.compression.count; c++)
+    for (int d = 0; d < m.weight0.count; d++)
+    for (int e = 0; e < m.alpha.count; e++)
+    for (int f = 0; f < m.modulo.count; f++)
+    for (int g = 0; g < m.backend.count; g++) {
+        bench_scenario_t scenario = {
+            .image = m.images.values[a],
+            .movements = m.movements.values[b],
+            .compression = atoi(m.compression.values[c]),
+            .weight0 = atoi(m.weight0.values[d]),
+            .alpha = atoi(m.alpha.values[e]),
+            .modulo = atoi(m.modulo.values[f]),
+            .backend = m.backend.values[g]
+        };
+        log_info("Scénario %s %s compression=%d weight0=%d alpha=%d modulo=%d backend=%s",
+                 scenario.image, scenario.movements, scenario.compression, scenario.weight0,
+                 scenario.alpha, scenario.modulo, scenario.backend);
+
+        int count = 0;
+        for (int r = 0; r < m.repetitions; r++) {
+            bench_sample_t sample = bench_run_isolated(scenario);
+            if (!sample.ok) {
+                log_error("Echec de la répétition %d du scénario", r + 1);
+                continue;
+            }
+            samples[count++] = sample;
+        }
+        if (count == 0) continue;
+        bench_report(csv, json, first, scenario, samples, count);
+        first = false;
+    }
+
+    fprintf(json, "\n]\n");
+    fclose(csv);
+    fclose(json);
+    log_info("Résultats écrits dans %s.csv et %s.json", prefix, prefix);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <stdlib.h>
+
+#include "arena.h"
+#include "instrument.h"
+
+#define ARENA_ALIGN 16
+
+// Bloc d'une zone
+struct arena_block_s {
+    struct arena_block_s* next;
+    size_t size;
+    size_t used;
+    char* data;
+};
+typedef struct arena_block_s arena_block_t;
+
+struct arena_s {
+    arena_block_t* first;
+    arena_block_t* current;
+    size_t block_size;
+};
+
+// Allouer un bloc d'au moins size octets
+arena_block_t* arena_block_create(size_t size) {
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, sizeof(arena_block_t) + size);
+    arena_block_t* block = (arena_block_t*) malloc(sizeof(arena_block_t) + size + ARENA_ALIGN);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    // Les données commencent après l'en-tête, alignées
+    size_t start = ((size_t) (block + 1) + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+    block->data = (char*) start;
+    return block;
+}
+
+// Créer une zone dont les blocs font au moins block_size octets
+arena_t* arena_create(size_t block_size) {
+    arena_t* arena = (arena_t*) malloc(sizeof(arena_t));
+    arena->block_size = block_size;
+    arena->first = arena_block_create(block_size);
+    arena->current = arena->first;
+    return arena;
+}
+
+// Allouer size octets dans la zone, alignés sur la plus grande puissance de deux (au plus ARENA_ALIGN)
+// qui divise size : un position_t de 8 octets n'occupe que 8 octets
+void* arena_alloc(arena_t* arena, size_t size) {
+    size_t align = ARENA_ALIGN;
+    while (align > 1 && size % align != 0) align /= 2;
+    arena_block_t* block = arena->current;
+    size_t start = (block->used + align - 1) & ~(align - 1);
+    while (start + size > block->size) {
+        // Les blocs suivants ont déjà servi avant la dernière remise à zéro : on les reprend
+        if (block->next != NULL && block->next->size >= size) {
+            block = block->next;
+            block->used = 0;
+        }
+        else {
+            arena_block_t* fresh = arena_block_create(size > arena->block_size ? size : arena->block_size);
+            fresh->next = block->next;
+            block->next = fresh;
+            block = fresh;
+        }
+        start = 0;
+    }
+    arena->current = block;
+    block->used = start + size;
+    return block->data + start;
+}
+
+// Libérer toutes les allocations de la zone en temps constant (les blocs sont réutilisés)
+void arena_reset(arena_t* arena) {
+    arena->current = arena->first;
+    arena->first->used = 0;
+}
+
+// Libérer la zone et ses blocs
+void arena_free(arena_t* arena) {
+    arena_block_t* block = arena->first;
+    while (block != NULL) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
@@ -0,0 +1,22 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Zone d'allocation par blocs : les allocations avancent dans des blocs de taille fixe
+// et sont toutes libérées d'un coup par arena_reset, sans libérer les blocs
+typedef struct arena_s arena_t;
+
+// Créer une zone dont les blocs font au moins block_size octets
+arena_t* arena_create(size_t block_size);
+
+// Allouer size octets dans la zone (alignés sur 16 octets au plus, selon la taille demandée)
+void* arena_alloc(arena_t* arena, size_t size);
+
+// Libérer toutes les allocations de la zone en temps constant (les blocs sont réutilisés)
+void arena_reset(arena_t* arena);
+
+// Libérer la zone et ses blocs
+void arena_free(arena_t* arena);
+
+#endif // ARENA_H
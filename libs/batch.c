@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "batch.h"
+#include "image.h"
+#include "image_usage.h"
+#include "crowd.h"
+#include "csv.h"
+#include "queue.h"
+#include "route.h"
+#include "resample.h"
+#include "parallel.h"
+#include "render.h"
+#include "logging.h"
+#include "common.h"
+
+int BATCH_CACHE_SIZE = 8; // Environnements gardés en mémoire par défaut
+
+#define BATCH_PATH_SIZE 1024
+#define BATCH_MODULO 10
+
+// Etat d'une entrée du cache
+#define BATCH_LOADING 0
+#define BATCH_READY 1
+#define BATCH_FAILED 2
+
+// Flux de réponses d'une connexion
+struct batch_stream_s {
+    FILE* file;
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+    int pending;              // Travaux lus mais pas encore terminés
+};
+typedef struct batch_stream_s batch_stream_t;
+
+// Un travail
+struct batch_job_s {
+    int id;
+    char image[BATCH_PATH_SIZE];
+    char movements[BATCH_PATH_SIZE];
+    int weight0;
+    int alpha;
+    int compression;
+    char output[BATCH_PATH_SIZE];
+    batch_stream_t* stream;
+};
+typedef struct batch_job_s batch_job_t;
+
+// Environnement prétraité, partagé par les travaux sur la même image avec la même compression
+struct batch_entry_s {
+    char image[BATCH_PATH_SIZE];
+    int compression;
+    int state;
+    colored_image_t colored;  // Image d'origine, recopiée pour chaque rendu
+    environment_t env;        // Environnement sans agents, recopié pour chaque travail
+    int refs;                 // Travaux utilisant l'entrée
+    long long last_use;
+    struct batch_entry_s* next;
+};
+typedef struct batch_entry_s batch_entry_t;
+
+// Cache des environnements
+batch_entry_t* batch_entries = NULL;
+int batch_entry_count = 0;
+long long batch_clock = 0;
+pthread_mutex_t batch_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t batch_cache_changed = PTHREAD_COND_INITIALIZER;
+
+// File des travaux et fils de travail
+queue_t* batch_jobs = NULL;
+bool batch_stopping = false;
+pthread_mutex_t batch_jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t batch_jobs_changed = PTHREAD_COND_INITIALIZER;
+pthread_t* batch_workers = NULL;
+int batch_worker_count = 0;
+
+// Horloge monotone en secondes
+double batch_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Ecrire une réponse et marquer le travail comme terminé
+void batch_reply(batch_stream_t* stream, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&stream->mutex);
+    vfprintf(stream->file, format, args);
+    fputc('\n', stream->file);
+    fflush(stream->file);
+    stream->pending--;
+    pthread_cond_signal(&stream->done);
+    pthread_mutex_unlock(&stream->mutex);
+    va_end(args);
+}
+
+// Libérer une entrée du cache
+void batch_entry_free(batch_entry_t* entry) {
+    if (entry->state == BATCH_READY) {
+        colored_image_free(entry->colored);
+        env_free(entry->env);
+    }
+    free(entry);
+}
+
+// Retirer une entrée de la liste (verrou du cache tenu)
+void batch_entry_unlink(batch_entry_t* entry) {
+    for (batch_entry_t** e = &batch_entries; *e != NULL; e = &(*e)->next) {
+        if (*e == entry) {
+            *e = entry->next;
+            batch_entry_count--;
+            return;
+        }
+    }
+}
+
+// Evincer les entrées inutilisées les plus anciennes au-delà de la taille du cache (verrou du cache tenu)
+void batch_cache_evict() {
+    while (batch_entry_count > BATCH_CACHE_SIZE) {
+        batch_entry_t* oldest = NULL;
+        for (batch_entry_t* e = batch_entries; e != NULL; e = e->next) {
+            if (e->refs == 0 && e->state == BATCH_READY && (oldest == NULL || e->last_use < oldest->last_use)) {
+                oldest = e;
+            }
+        }
+        if (oldest == NULL) return; // Toutes les entrées sont utilisées
+        log_debug("Environnement retiré du cache : %s (compression %d)", oldest->image, oldest->compression);
+        batch_entry_unlink(oldest);
+        batch_entry_free(oldest);
+    }
+}
+
+// Prétraiter une image : lecture, niveaux de gris, réduction, Canny, fermeture, environnement
+bool batch_entry_load(batch_entry_t* entry) {
+    log_debug("Prétraitement de l'image : %s (compression %d)", entry->image, entry->compression);
+    // Une image illisible fait échouer ce travail, pas le serveur
+    if (!image_try_read(entry->image, &entry->colored)) {
+        log_error("Erreur lors de la lecture de l'image : %s", entry->image);
+        return false;
+    }
+
+    int n = entry->compression;
+    image_t image = (n > 1) ? image_from_colored_image_resampled(entry->colored, n)
+                            : image_from_colored_image(entry->colored);
+    image_t canny_image = canny(image, 0.1, 0.2);
+    image_t image_morpho = image_fermeture_morphologique(canny_image, 30/n);
+    entry->env = env_from_image(image_morpho);
+
+    image_free(image_morpho);
+    image_free(canny_image);
+    image_free(image);
+    return true;
+}
+
+// Obtenir l'environnement d'une image, en le prétraitant s'il n'est pas dans le cache
+batch_entry_t* batch_acquire(const char* image, int compression, bool* hit) {
+    pthread_mutex_lock(&batch_cache_mutex);
+    batch_entry_t* entry = batch_entries;
+    while (entry != NULL && (entry->compression != compression || strcmp(entry->image, image) != 0)) {
+        entry = entry->next;
+    }
+    *hit = entry != NULL;
+
+    if (entry == NULL) {
+        // Le prétraitement se fait hors du verrou, les autres travaux sur cette image attendent
+        entry = (batch_entry_t*) calloc(1, sizeof(batch_entry_t));
+        snprintf(entry->image, BATCH_PATH_SIZE, "%s", image);
+        entry->compression = compression;
+        entry->state = BATCH_LOADING;
+        entry->refs = 1;
+        entry->next = batch_entries;
+        batch_entries = entry;
+        batch_entry_count++;
+        pthread_mutex_unlock(&batch_cache_mutex);
+
+        bool loaded = batch_entry_load(entry);
+
+        pthread_mutex_lock(&batch_cache_mutex);
+        entry->state = loaded ? BATCH_READY : BATCH_FAILED;
+        if (!loaded) batch_entry_unlink(entry);
+        pthread_cond_broadcast(&batch_cache_changed);
+    }
+    else {
+        entry->refs++;
+        while (entry->state == BATCH_LOADING) pthread_cond_wait(&batch_cache_changed, &batch_cache_mutex);
+    }
+
+    if (entry->state == BATCH_FAILED) {
+        // Le dernier travail à l'attendre libère l'entrée
+        if (--entry->refs == 0) batch_entry_free(entry);
+        entry = NULL;
+    }
+    else {
+        entry->last_use = ++batch_clock;
+        batch_cache_evict();
+    }
+    pthread_mutex_unlock(&batch_cache_mutex);
+    return entry;
+}
+
+// Rendre une entrée au cache
+void batch_release(batch_entry_t* entry) {
+    pthread_mutex_lock(&batch_cache_mutex);
+    entry->refs--;
+    batch_cache_evict();
+    pthread_mutex_unlock(&batch_cache_mutex);
+}
+
+// Vérifier que les mouvements restent dans l'environnement
+bool batch_movements_valid(movement_list_t* movements, environment_t* env) {
+    bool valid = true;
+    for (int k = movements->first; k < movements->size; k++) {
+        movement_t* m = &movements->items[k];
+        if (m->start.i < 0 || m->start.i + m->start_span.i >= env->rows
+                || m->start.j < 0 || m->start.j + m->start_span.j >= env->cols
+                || m->target.i < 0 || m->target.i + m->target_span.i >= env->rows
+                || m->target.j < 0 || m->target.j + m->target_span.j >= env->cols) {
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+// Exécuter un travail ; arrays porte la taille des tableaux de recherche du fil courant
+void batch_execute(batch_job_t* job, environment_t* arrays) {
+    double job_start = batch_now();
+    log_debug("Travail %d : %s, %s", job->id, job->image, job->movements);
+
+    bool hit;
+    batch_entry_t* entry = batch_acquire(job->image, job->compression, &hit);
+    if (entry == NULL) {
+        batch_reply(job->stream, "error %d image illisible : %s", job->id, job->image);
+        return;
+    }
+
+    movement_list_t* movements = load_movements(job->movements, job->compression);
+    if (movements == NULL) {
+        batch_release(entry);
+        batch_reply(job->stream, "error %d mouvements illisibles : %s", job->id, job->movements);
+        return;
+    }
+    if (!batch_movements_valid(movements, &entry->env)) {
+        free_movements(movements);
+        batch_release(entry);
+        batch_reply(job->stream, "error %d mouvements hors de l'image : %s", job->id, job->movements);
+        return;
+    }
+
+    environment_t env = env_copy(entry->env);
+    double routing_start = batch_now();
+    // Les tableaux de recherche du fil sont gardés d'un travail à l'autre tant que la taille ne change pas
+    if (arrays->rows != env.rows || arrays->cols != env.cols) {
+        if (arrays->rows > 0) env_liberer_tableaux(arrays);
+        env_initialiser_tableaux(&env);
+        arrays->rows = env.rows;
+        arrays->cols = env.cols;
+    }
+    else {
+        env_reinitialiser_tableaux(&env);
+    }
+    multiple_move_env_route(movements, &env, job->weight0, job->alpha, BATCH_MODULO);
+    double routing_time = batch_now() - routing_start;
+
+    // L'image du cache n'est pas modifiée : le rendu écrit dans un nouveau tampon
+    render_colored_write(entry->colored, env, job->compression, job->output);
+
+    int max = env.max;
+    env_free(env);
+    free_movements(movements);
+    batch_release(entry);
+
+    batch_reply(job->stream, "ok %d %s %d %.6f %.6f %s", job->id, job->output, max, routing_time,
+                batch_now() - job_start, hit ? "hit" : "miss");
+}
+
+// Point d'entrée d'un fil de travail
+void* batch_worker(void* arg) {
+    (void) arg;
+    environment_t arrays = {.rows = 0, .cols = 0, .agents = NULL, .max = 0};
+    while (true) {
+        pthread_mutex_lock(&batch_jobs_mutex);
+        while (queue_is_empty(batch_jobs) && !batch_stopping) {
+            pthread_cond_wait(&batch_jobs_changed, &batch_jobs_mutex);
+        }
+        if (queue_is_empty(batch_jobs)) {
+            pthread_mutex_unlock(&batch_jobs_mutex);
+            break;
+        }
+        batch_job_t* job = *(batch_job_t**) queue_dequeue(batch_jobs);
+        pthread_mutex_unlock(&batch_jobs_mutex);
+
+        batch_execute(job, &arrays);
+        free(job);
+    }
+    if (arrays.rows > 0) env_liberer_tableaux(&arrays);
+    return NULL;
+}
+
+// Lancer les fils de travail
+void batch_start() {
+    batch_jobs = queue_create(sizeof(batch_job_t*));
+    batch_stopping = false;
+    batch_worker_count = parallel_threads();
+    batch_workers = (pthread_t*) malloc(sizeof(pthread_t) * batch_worker_count);
+    for (int w = 0; w < batch_worker_count; w++) {
+        pthread_create(&batch_workers[w], NULL, batch_worker, NULL);
+    }
+    log_info("Mode batch : %d fils de travail, %d environnements en cache", batch_worker_count, BATCH_CACHE_SIZE);
+}
+
+// Attendre la fin des travaux en cours, arrêter les fils de travail et vider le cache
+void batch_stop() {
+    pthread_mutex_lock(&batch_jobs_mutex);
+    batch_stopping = true;
+    pthread_cond_broadcast(&batch_jobs_changed);
+    pthread_mutex_unlock(&batch_jobs_mutex);
+    for (int w = 0; w < batch_worker_count; w++) {
+        pthread_join(batch_workers[w], NULL);
+    }
+    free(batch_workers);
+    queue_free(batch_jobs);
+    batch_workers = NULL;
+    batch_jobs = NULL;
+
+    while (batch_entries != NULL) {
+        batch_entry_t* entry = batch_entries;
+        batch_entries = entry->next;
+        batch_entry_free(entry);
+    }
+    batch_entry_count = 0;
+}
+
+// Lire un travail ; renvoie false si la ligne est mal formée
+bool batch_parse(const char* line, batch_job_t* job) {
+    char format[64];
+    snprintf(format, sizeof(format), "%%%ds %%%ds %%d %%d %%d %%%ds", BATCH_PATH_SIZE - 1,
+             BATCH_PATH_SIZE - 1, BATCH_PATH_SIZE - 1);
+    if (sscanf(line, format, job->image, job->movements, &job->weight0, &job->alpha,
+               &job->compression, job->output) != 6) return false;
+    return job->weight0 >= 0 && job->alpha >= 0 && (job->weight0 > 0 || job->alpha > 0) && job->compression > 0;
+}
+
+// Traiter les travaux lus sur input et écrire les résultats sur output au fur et à mesure
+bool batch_run(FILE* input, FILE* output) {
+    batch_stream_t stream = {.file = output, .pending = 0};
+    pthread_mutex_init(&stream.mutex, NULL);
+    pthread_cond_init(&stream.done, NULL);
+
+    bool running = true;
+    char line[4 * BATCH_PATH_SIZE];
+    int id = 0;
+    while (fgets(line, sizeof(line), input)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        const char* text = line + strspn(line, " \t");
+        if (*text == '\0' || *text == '#') continue;
+        if (strcmp(text, "quit") == 0) {
+            running = false;
+            break;
+        }
+
+        batch_job_t* job = (batch_job_t*) malloc(sizeof(batch_job_t));
+        job->id = ++id;
+        job->stream = &stream;
+        pthread_mutex_lock(&stream.mutex);
+        stream.pending++;
+        pthread_mutex_unlock(&stream.mutex);
+
+        if (!batch_parse(text, job)) {
+            batch_reply(&stream, "error %d travail mal formé : %s", job->id, text);
+            free(job);
+            continue;
+        }
+        pthread_mutex_lock(&batch_jobs_mutex);
+        queue_enqueue(batch_jobs, &job);
+        pthread_cond_signal(&batch_jobs_changed);
+        pthread_mutex_unlock(&batch_jobs_mutex);
+    }
+
+    // Les réponses de cette connexion doivent toutes être écrites avant de rendre la main
+    pthread_mutex_lock(&stream.mutex);
+    while (stream.pending > 0) pthread_cond_wait(&stream.done, &stream.mutex);
+    pthread_mutex_unlock(&stream.mutex);
+    pthread_mutex_destroy(&stream.mutex);
+    pthread_cond_destroy(&stream.done);
+    return running;
+}
+
+// Mode serveur : accepter les connexions sur une socket locale jusqu'à la ligne "quit"
+void batch_serve(const char* socket_path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) log_fatal("Chemin de socket trop long : %s", socket_path);
+    strcpy(address.sun_path, socket_path);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) log_fatal("Erreur lors de la création de la socket");
+    unlink(socket_path);
+    if (bind(server, (struct sockaddr*) &address, sizeof(address)) < 0 || listen(server, 8) < 0) {
+        log_fatal("Erreur lors de l'ouverture de la socket : %s", socket_path);
+    }
+    // Un client qui se déconnecte avant ses réponses ne doit pas arrêter le serveur
+    signal(SIGPIPE, SIG_IGN);
+
+    batch_start();
+    log_info("En attente de travaux sur %s", socket_path);
+    bool running = true;
+    while (running) {
+        int client = accept(server, NULL, NULL);
+        if (client < 0) continue;
+        // Les connexions sont servies l'une après l'autre, les travaux d'une connexion en parallèle
+        FILE* input = fdopen(client, "r");
+        FILE* output = fdopen(dup(client), "w");
+        running = batch_run(input, output);
+        fclose(output);
+        fclose(input);
+    }
+    batch_stop();
+
+    close(server);
+    unlink(socket_path);
+}
@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// Nombre maximal d'environnements gardés en mémoire entre deux travaux
+extern int BATCH_CACHE_SIZE;
+
+// Lancer les fils de travail
+void batch_start();
+
+// Attendre la fin des travaux en cours, arrêter les fils de travail et vider le cache
+void batch_stop();
+
+// Traiter les travaux lus sur input (un par ligne) et écrire les résultats sur output au fur et à mesure
+// Format d'un travail : <image> <mouvements> <weight0> <alpha> <compression> <sortie>
+// Les fils de travail doivent être lancés ; renvoie false si la ligne "quit" a été lue
+bool batch_run(FILE* input, FILE* output);
+
+// Mode serveur : accepter les connexions sur une socket locale jusqu'à la ligne "quit"
+void batch_serve(const char* socket_path);
+
+#endif
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "bucket_queue.h"
+#include "instrument.h"
+
+// Créer une file à seaux
+bucket_queue_t* bq_create(int capacity) {
+    bucket_queue_t* bq = (bucket_queue_t*) malloc(sizeof(bucket_queue_t));
+    bq->nodes = (bucket_node_t*) malloc(sizeof(bucket_node_t) * capacity);
+    bq->heads = (int*) malloc(sizeof(int) * capacity);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 3);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) (sizeof(bucket_node_t) + sizeof(int)) * capacity);
+    for (int k = 0; k < capacity; k++) bq->heads[k] = -1;
+    bq->buckets = capacity;
+    bq->used = 0;
+    bq->capacity = capacity;
+    bq->len = 0;
+    bq->cursor = 0;
+    bq->highest = 0;
+    return bq;
+}
+
+// Libérer une file à seaux
+void bq_free(bucket_queue_t* bq) {
+    free(bq->nodes);
+    free(bq->heads);
+    free(bq);
+}
+
+// Ajouter un élément à la file à seaux
+void bq_push(bucket_queue_t* bq, int priority, void* value) {
+    if (priority < 0) priority = 0;
+    if (priority > BQ_MAX_PRIORITY) priority = BQ_MAX_PRIORITY;
+    // Agrandir les seaux jusqu'à la priorité demandée
+    if (priority >= bq->buckets) {
+        int buckets = (2 * bq->buckets > priority) ? 2 * bq->buckets : priority + 1;
+        if (buckets > BQ_MAX_PRIORITY + 1) buckets = BQ_MAX_PRIORITY + 1;
+        bq->heads = (int*) realloc(bq->heads, sizeof(int) * buckets);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(int) * buckets);
+        if (bq->heads == NULL) {
+            printf("Erreur : mémoire insuffisante pour la file à seaux.\n");
+            exit(-1);
+        }
+        for (int k = bq->buckets; k < buckets; k++) bq->heads[k] = -1;
+        bq->buckets = buckets;
+    }
+    // Doubler les noeuds lorsque tous sont utilisés
+    if (bq->used == bq->capacity) {
+        bq->capacity = bq->capacity > 0 ? 2 * bq->capacity : 16;
+        bq->nodes = (bucket_node_t*) realloc(bq->nodes, sizeof(bucket_node_t) * bq->capacity);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(bucket_node_t) * bq->capacity);
+        if (bq->nodes == NULL) {
+            printf("Erreur : mémoire insuffisante pour la file à seaux.\n");
+            exit(-1);
+        }
+    }
+
+    INSTR_COUNT(INSTR_COUNTER_PUSHES, 1);
+    bq->nodes[bq->used].value = value;
+    bq->nodes[bq->used].next = bq->heads[priority];
+    bq->heads[priority] = bq->used;
+    bq->used++;
+    bq->len++;
+    if (bq->len == 1 || priority < bq->cursor) bq->cursor = priority;
+    if (priority > bq->highest) bq->highest = priority;
+}
+
+// Extraire un élément de plus petite priorité
+void* bq_pop(bucket_queue_t* bq) {
+    if (bq->len == 0) {
+        fprintf(stderr, "Erreur : la file à seaux est vide.\n");
+        exit(-1);
+    }
+
+    INSTR_COUNT(INSTR_COUNTER_POPS, 1);
+    while (bq->heads[bq->cursor] == -1) bq->cursor++;
+    int node = bq->heads[bq->cursor];
+    bq->heads[bq->cursor] = bq->nodes[node].next;
+    bq->len--;
+    return bq->nodes[node].value;
+}
+
+// Vider la file à seaux : seuls les seaux entre le curseur et le plus haut utilisé peuvent être occupés
+void bq_clear(bucket_queue_t* bq) {
+    if (bq->len > 0) {
+        for (int k = bq->cursor; k <= bq->highest; k++) bq->heads[k] = -1;
+    }
+    bq->used = 0;
+    bq->len = 0;
+    bq->cursor = 0;
+    bq->highest = 0;
+}
+
+// Vérifier si la file à seaux est vide
+bool bq_is_empty(bucket_queue_t* bq) {
+    return bq->len == 0;
+}
@@ -0,0 +1,37 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <stdbool.h>
+
+// Noeud d'une liste de seau
+typedef struct bucket_node_s {
+    void* value;    // La valeur associée
+    int next;       // Noeud suivant du même seau (-1 pour le dernier)
+} bucket_node_t;
+
+// File à seaux : un seau par priorité entière, la plus petite priorité non vide est cherchée à partir
+// d'un curseur qui n'avance qu'entre deux insertions plus basses. Les éléments d'un même seau sortent dans
+// l'ordre inverse de leur insertion.
+typedef struct bucket_queue_s {
+    int* heads;             // Premier noeud de chaque seau (-1 si vide)
+    int buckets;            // Nombre de seaux alloués (agrandi au besoin)
+    bucket_node_t* nodes;   // Noeuds, réutilisés seulement après un vidage
+    int used;               // Noeuds utilisés depuis le dernier vidage
+    int capacity;           // Noeuds alloués (doublés lorsque tous sont utilisés)
+    int len;                // Nombre d'éléments dans la file
+    int cursor;             // Aucun seau non vide avant le curseur
+    int highest;            // Plus haut seau utilisé depuis le dernier vidage
+} bucket_queue_t;
+
+// Plus haute priorité d'un seau (64 Mo de têtes) : les priorités au-delà partagent le dernier seau
+#define BQ_MAX_PRIORITY (1 << 24)
+
+// Fonctions pour manipuler la file à seaux
+bucket_queue_t* bq_create(int capacity); // Créer une file à seaux
+void bq_free(bucket_queue_t* bq); // Libérer une file à seaux
+void bq_push(bucket_queue_t* bq, int priority, void* value); // Ajouter un élément (priorité ramenée entre 0 et BQ_MAX_PRIORITY)
+void* bq_pop(bucket_queue_t* bq); // Extraire un élément de plus petite priorité
+void bq_clear(bucket_queue_t* bq); // Vider la file
+bool bq_is_empty(bucket_queue_t* bq); // Vérifier si la file est vide
+
+#endif // BUCKET_QUEUE_H
@@ -0,0 +1,497 @@
+#include <opencv2/opencv.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "canny_stream.h"
+#include "image.h"
+#include "image_usage.h"
+#include "logging.h"
+
+// Lecteur de lignes
+
+// Lire un entier de l'en-tête d'un fichier PNM (en sautant les commentaires)
+int pnm_read_header_int(FILE* file) {
+    int c = fgetc(file);
+    while (c == '#' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(file);
+        }
+        c = fgetc(file);
+    }
+    int value = 0;
+    while (c >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        c = fgetc(file);
+    }
+    return value;
+}
+
+// Ouvrir un lecteur de lignes sur une image
+row_reader_t row_reader_open(const char* path, int strip_rows) {
+    log_debug("Ouverture d'un lecteur de lignes sur l'image : %s", path);
+    if (strip_rows <= 0) log_fatal("Taille de bande invalide (%d)", strip_rows);
+
+    row_reader_t reader = {
+        .file = NULL,
+        .data_offset = 0,
+        .mat = cv::Mat(),
+        .rows = 0,
+        .cols = 0,
+        .channels = 3,
+        .strip_rows = strip_rows,
+        .strip_start = 0,
+        .strip_len = 0,
+        .strip = NULL
+    };
+
+    // Les PNM binaires 8 bits sont lus bande par bande sans jamais être chargés en entier
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) log_fatal("Erreur lors de la lecture de l'image : %s", path);
+    char magic[2] = {0, 0};
+    if (fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6')) {
+        int cols = pnm_read_header_int(file);
+        int rows = pnm_read_header_int(file);
+        int max_value = pnm_read_header_int(file);
+        if (max_value == 255 && rows > 0 && cols > 0) {
+            reader.file = file;
+            reader.data_offset = ftell(file);
+            reader.rows = rows;
+            reader.cols = cols;
+            reader.channels = (magic[1] == '5') ? 1 : 3;
+        }
+    }
+
+    // Les autres formats sont décodés par OpenCV en 8 bits (3 octets par pixel au lieu de 24)
+    if (reader.file == NULL) {
+        fclose(file);
+        log_warning("Format non lisible par bandes, décodage complet de l'image : %s", path);
+        reader.mat = cv::imread(path, cv::IMREAD_COLOR);
+        if (reader.mat.empty()) log_fatal("Erreur lors de la lecture de l'image : %s", path);
+        reader.rows = reader.mat.rows;
+        reader.cols = reader.mat.cols;
+    }
+    else {
+        reader.strip = (unsigned char*) malloc(sizeof(unsigned char) * strip_rows * reader.cols * reader.channels);
+    }
+
+    log_debug("Lecteur de lignes ouvert (%d x %d) : %s", reader.rows, reader.cols, path);
+    return reader;
+}
+
+// Revenir au début de l'image
+void row_reader_rewind(row_reader_t* reader) {
+    if (reader->file != NULL) fseek(reader->file, reader->data_offset, SEEK_SET);
+    reader->strip_start = 0;
+    reader->strip_len = 0;
+}
+
+// Lire la ligne suivante en niveaux de gris (les lignes sont lues dans l'ordre)
+void row_reader_read(row_reader_t* reader, int i, pixel_t* row) {
+    // Repli : ligne de l'image décodée, même pondération que image_from_colored_image
+    if (reader->file == NULL) {
+        cv::Vec3b* colors = reader->mat.ptr<cv::Vec3b>(i);
+        for (int j = 0; j < reader->cols; j++) {
+            row[j] = (0.299 * (double) colors[j][2] + 0.587 * (double) colors[j][1]
+                      + 0.114 * (double) colors[j][0]) / 255.0;
+        }
+        return;
+    }
+
+    // Lecture de la bande suivante si nécessaire
+    if (i >= reader->strip_start + reader->strip_len) {
+        reader->strip_start = i;
+        reader->strip_len = reader->rows - i < reader->strip_rows ? reader->rows - i : reader->strip_rows;
+        size_t size = (size_t) reader->strip_len * reader->cols * reader->channels;
+        if (fread(reader->strip, 1, size, reader->file) != size) {
+            log_fatal("Erreur lors de la lecture de la bande commençant à la ligne %d", i);
+        }
+    }
+
+    unsigned char* data = reader->strip + (size_t) (i - reader->strip_start) * reader->cols * reader->channels;
+    for (int j = 0; j < reader->cols; j++) {
+        double r, g, b;
+        if (reader->channels == 1) {
+            r = g = b = (double) data[j];
+        }
+        else {
+            r = (double) data[3 * j];
+            g = (double) data[3 * j + 1];
+            b = (double) data[3 * j + 2];
+        }
+        row[j] = (0.299 * r + 0.587 * g + 0.114 * b) / 255.0;
+    }
+}
+
+// Fermer un lecteur de lignes
+void row_reader_close(row_reader_t* reader) {
+    if (reader->file != NULL) fclose(reader->file);
+    free(reader->strip);
+    reader->mat.release();
+}
+
+// Tampons de lignes
+
+// Tampon circulaire conservant les dernières lignes calculées d'une étape
+struct row_ring_s {
+    int size;        // Nombre de lignes conservées
+    int next;        // Prochaine ligne à calculer
+    pixel_t** rows;
+};
+typedef struct row_ring_s row_ring_t;
+
+// Créer un tampon circulaire de lignes
+row_ring_t row_ring_create(int size, int cols) {
+    row_ring_t ring = {
+        .size = size,
+        .next = 0,
+        .rows = (pixel_t**) malloc(sizeof(pixel_t*) * size)
+    };
+    for (int k = 0; k < size; k++) {
+        ring.rows[k] = (pixel_t*) malloc(sizeof(pixel_t) * cols);
+    }
+    return ring;
+}
+
+// Libérer un tampon circulaire de lignes
+void row_ring_free(row_ring_t ring) {
+    for (int k = 0; k < ring.size; k++) {
+        free(ring.rows[k]);
+    }
+    free(ring.rows);
+}
+
+// Ligne i d'un tampon circulaire (doit encore être conservée)
+pixel_t* row_ring_get(row_ring_t* ring, int i) {
+    return ring->rows[i % ring->size];
+}
+
+// Etat du pipeline de Canny par bandes
+struct canny_stream_s {
+    row_reader_t reader;
+    int rows;
+    int cols;
+    double t_max;
+    double t_min;
+    int mean;               // Demi-taille de l'élément structurant de la fermeture
+    int strip_rows;
+    bool normalize;         // Faux pendant la première passe (recherche des extrema du gradient)
+    double g_min;
+    double g_max;
+    kernel_t gaussian;
+    kernel_t sobel_x;
+    kernel_t sobel_y;
+    row_ring_t grey;        // Image en niveaux de gris (5 lignes pour le flou)
+    row_ring_t blur;        // Image floutée (3 lignes pour Sobel)
+    row_ring_t magnitude;   // Norme du gradient (3 lignes pour les non-maxima)
+    row_ring_t direction;   // Direction du gradient
+    row_ring_t threshold;   // Double seuil (recouvrement + bande + anticipation)
+    row_ring_t edges;       // Contours après hystérésis
+    row_ring_t dilated;     // Dilatation de la fermeture
+    pixel_t* saved;         // Copie des lignes d'anticipation avant hystérésis
+    pixel_t** window;       // Vue des lignes traitées par l'hystérésis
+};
+typedef struct canny_stream_s canny_stream_t;
+
+// Indice réfléchi aux bords (comme image_apply_filter)
+int stream_reflect(int k, int n) {
+    if (k < 0) k = -k;
+    if (k >= n) k = 2 * n - k - 1;
+    return k;
+}
+
+// Ligne i de l'image en niveaux de gris
+pixel_t* stream_grey_row(canny_stream_t* s, int i) {
+    while (s->grey.next <= i) {
+        row_reader_read(&s->reader, s->grey.next, row_ring_get(&s->grey, s->grey.next));
+        s->grey.next++;
+    }
+    return row_ring_get(&s->grey, i);
+}
+
+// Appliquer un noyau à la ligne i à partir des lignes voisines (réflexion aux bords)
+void stream_filter_row(pixel_t** neighbours, kernel_t kernel, int cols, pixel_t* out) {
+    int border = kernel.size / 2;
+    for (int j = 0; j < cols; j++) {
+        pixel_t intensity = 0;
+        for (int x = 0; x < kernel.size; x++) {
+            for (int y = 0; y < kernel.size; y++) {
+                int nj = stream_reflect(j + y - border, cols);
+                intensity += neighbours[x][nj] * kernel.data[x][y];
+            }
+        }
+        out[j] = intensity;
+    }
+}
+
+// Ligne i de l'image floutée
+pixel_t* stream_blur_row(canny_stream_t* s, int i) {
+    while (s->blur.next <= i) {
+        int k = s->blur.next;
+        int border = s->gaussian.size / 2;
+        pixel_t* neighbours[s->gaussian.size];
+        // Les lignes les plus basses sont lues en premier pour ne pas écraser les plus hautes
+        stream_grey_row(s, stream_reflect(k + border, s->rows));
+        for (int x = 0; x < s->gaussian.size; x++) {
+            neighbours[x] = stream_grey_row(s, stream_reflect(k + x - border, s->rows));
+        }
+        stream_filter_row(neighbours, s->gaussian, s->cols, row_ring_get(&s->blur, k));
+        s->blur.next++;
+    }
+    return row_ring_get(&s->blur, i);
+}
+
+// Ligne i de la norme du gradient (normalisée pendant la seconde passe)
+pixel_t* stream_magnitude_row(canny_stream_t* s, int i) {
+    while (s->magnitude.next <= i) {
+        int k = s->magnitude.next;
+        pixel_t* neighbours[3];
+        stream_blur_row(s, stream_reflect(k + 1, s->rows));
+        for (int x = 0; x < 3; x++) {
+            neighbours[x] = stream_blur_row(s, stream_reflect(k + x - 1, s->rows));
+        }
+
+        pixel_t* magnitude = row_ring_get(&s->magnitude, k);
+        pixel_t* direction = row_ring_get(&s->direction, k);
+        // La direction sert de tampon pour le gradient en x
+        stream_filter_row(neighbours, s->sobel_x, s->cols, direction);
+        stream_filter_row(neighbours, s->sobel_y, s->cols, magnitude);
+        for (int j = 0; j < s->cols; j++) {
+            double gx = direction[j];
+            double gy = magnitude[j];
+            magnitude[j] = sqrt(pow(gx, 2) + pow(gy, 2));
+            direction[j] = atan2(gx, gy);
+            if (s->normalize && s->g_max != s->g_min) {
+                magnitude[j] = (magnitude[j] - s->g_min) / (s->g_max - s->g_min);
+            }
+        }
+        s->magnitude.next++;
+        s->direction.next++;
+    }
+    return row_ring_get(&s->magnitude, i);
+}
+
+// Calculer la ligne i après suppression des non-maxima et double seuil
+void stream_threshold_row(canny_stream_t* s, int i, pixel_t* out) {
+    pixel_t* below = stream_magnitude_row(s, i + 1 < s->rows ? i + 1 : i);
+    pixel_t* current = stream_magnitude_row(s, i);
+    pixel_t* above = stream_magnitude_row(s, i > 0 ? i - 1 : i);
+    pixel_t* direction = row_ring_get(&s->direction, i);
+
+    // Les bords ne sont pas traités par la suppression des non-maxima
+    bool border_row = (i == 0 || i == s->rows - 1);
+    for (int j = 0; j < s->cols; j++) {
+        double value = current[j];
+        if (!border_row && j > 0 && j < s->cols - 1) {
+            double angle = fmod(direction[j] + M_PI, M_PI);
+            double q = 0.0;
+            double r = 0.0;
+            if ((angle >= 0 && angle < M_PI/8) || (angle >= 7*M_PI/8 && angle < M_PI)) {
+                q = current[j+1];
+                r = current[j-1];
+            } else if (angle >= M_PI/8 && angle < 3*M_PI/8) {
+                q = above[j+1];
+                r = below[j-1];
+            } else if (angle >= 3*M_PI/8 && angle < 5*M_PI/8) {
+                q = above[j];
+                r = below[j];
+            } else if (angle >= 5*M_PI/8 && angle < 7*M_PI/8) {
+                q = above[j-1];
+                r = below[j+1];
+            }
+            if (!(current[j] >= q && current[j] >= r)) value = 0;
+        }
+
+        if (value > s->t_max) out[j] = 1.;
+        else if (value < s->t_min) out[j] = 0.;
+        else out[j] = 1/2.;
+    }
+}
+
+// Appliquer l'hystérésis sur la bande suivante
+void stream_hysteresis_strip(canny_stream_t* s) {
+    int start = s->edges.next;
+    int end = start + s->strip_rows < s->rows ? start + s->strip_rows : s->rows;
+    int first = start - CANNY_STREAM_CARRY_ROWS > 0 ? start - CANNY_STREAM_CARRY_ROWS : 0;
+    int last = end + CANNY_STREAM_CARRY_ROWS < s->rows ? end + CANNY_STREAM_CARRY_ROWS : s->rows;
+
+    // Seuiller les lignes manquantes (la bande courante et l'anticipation)
+    while (s->threshold.next < last) {
+        stream_threshold_row(s, s->threshold.next, row_ring_get(&s->threshold, s->threshold.next));
+        s->threshold.next++;
+    }
+
+    // Les lignes d'anticipation gardent leurs pixels faibles pour la bande suivante
+    for (int i = end; i < last; i++) {
+        memcpy(s->saved + (size_t) (i - end) * s->cols, row_ring_get(&s->threshold, i), sizeof(pixel_t) * s->cols);
+    }
+
+    // Hystérésis sur la fenêtre : les lignes de recouvrement sont déjà définitives
+    for (int i = first; i < last; i++) {
+        s->window[i - first] = row_ring_get(&s->threshold, i);
+    }
+    image_t window = {
+        .name = (char*) "bande",
+        .rows = last - first,
+        .cols = s->cols,
+        .pixels = s->window
+    };
+    image_hysteresis(window);
+
+    for (int i = end; i < last; i++) {
+        pixel_t* row = row_ring_get(&s->threshold, i);
+        pixel_t* saved = s->saved + (size_t) (i - end) * s->cols;
+        for (int j = 0; j < s->cols; j++) {
+            if (row[j] != 1.) row[j] = saved[j];
+        }
+    }
+
+    for (int i = start; i < end; i++) {
+        memcpy(row_ring_get(&s->edges, i), row_ring_get(&s->threshold, i), sizeof(pixel_t) * s->cols);
+    }
+    s->edges.next = end;
+}
+
+// Ligne i des contours après hystérésis
+pixel_t* stream_edges_row(canny_stream_t* s, int i) {
+    while (s->edges.next <= i) {
+        stream_hysteresis_strip(s);
+    }
+    return row_ring_get(&s->edges, i);
+}
+
+// Appliquer une dilatation (dilate = vrai) ou une érosion à la ligne i à partir des lignes voisines
+void stream_morpho_row(pixel_t** neighbours, int count, pixel_t* current, int cols, int mean,
+                       bool dilate, int* column, pixel_t* out) {
+    // Nombre de lignes voisines déclenchant l'opération, colonne par colonne
+    for (int j = 0; j < cols; j++) {
+        column[j] = 0;
+        for (int x = 0; x < count; x++) {
+            if (dilate ? neighbours[x][j] > 0 : neighbours[x][j] < 1.0) {
+                column[j] = 1;
+                break;
+            }
+        }
+    }
+
+    // Fenêtre glissante horizontale sur les colonnes
+    int active = 0;
+    for (int j = 0; j < mean && j < cols; j++) active += column[j];
+    for (int j = 0; j < cols; j++) {
+        if (j + mean < cols) active += column[j + mean];
+        if (j - mean - 1 >= 0) active -= column[j - mean - 1];
+        if (active > 0) out[j] = dilate ? 1.0 : 0.0;
+        else out[j] = current[j];
+    }
+}
+
+// Ligne i de la dilatation
+pixel_t* stream_dilated_row(canny_stream_t* s, int i, int* column) {
+    while (s->dilated.next <= i) {
+        int k = s->dilated.next;
+        int top = k - s->mean > 0 ? k - s->mean : 0;
+        int bottom = k + s->mean < s->rows - 1 ? k + s->mean : s->rows - 1;
+        pixel_t* neighbours[bottom - top + 1];
+        stream_edges_row(s, bottom);
+        for (int x = top; x <= bottom; x++) {
+            neighbours[x - top] = stream_edges_row(s, x);
+        }
+        stream_morpho_row(neighbours, bottom - top + 1, stream_edges_row(s, k), s->cols, s->mean,
+                          true, column, row_ring_get(&s->dilated, k));
+        s->dilated.next++;
+    }
+    return row_ring_get(&s->dilated, i);
+}
+
+// Appliquer le filtre de Canny puis la fermeture morphologique par bandes horizontales
+void canny_stream(const char* input_path, const char* output_path,
+                  double t_max, double t_min, int closing_size, int strip_rows) {
+    log_debug("Application du filtre de Canny par bandes de %d lignes sur l'image : %s", strip_rows, input_path);
+
+    canny_stream_t s;
+    s.reader = row_reader_open(input_path, strip_rows);
+    s.rows = s.reader.rows;
+    s.cols = s.reader.cols;
+    s.t_max = t_max;
+    s.t_min = t_min;
+    s.mean = closing_size / 2;
+    s.strip_rows = strip_rows;
+    s.normalize = false;
+    s.g_min = 1.;
+    s.g_max = 0.;
+    s.gaussian = create_gaussian_kernel(5, 1.0);
+    s.sobel_x = create_sobel_kernel_x();
+    s.sobel_y = create_sobel_kernel_y();
+    s.grey = row_ring_create(s.gaussian.size, s.cols);
+    s.blur = row_ring_create(3, s.cols);
+    s.magnitude = row_ring_create(3, s.cols);
+    s.direction = row_ring_create(3, s.cols);
+    s.threshold = row_ring_create(strip_rows + 2 * CANNY_STREAM_CARRY_ROWS, s.cols);
+    s.edges = row_ring_create(strip_rows + 2 * s.mean + 1, s.cols);
+    s.dilated = row_ring_create(2 * s.mean + 1, s.cols);
+    s.saved = (pixel_t*) malloc(sizeof(pixel_t) * CANNY_STREAM_CARRY_ROWS * s.cols);
+    s.window = (pixel_t**) malloc(sizeof(pixel_t*) * (strip_rows + 2 * CANNY_STREAM_CARRY_ROWS));
+
+    // Première passe : extrema de la norme du gradient pour la normalisation
+    for (int i = 0; i < s.rows; i++) {
+        pixel_t* magnitude = stream_magnitude_row(&s, i);
+        for (int j = 0; j < s.cols; j++) {
+            if (magnitude[j] < s.g_min) s.g_min = magnitude[j];
+            if (magnitude[j] > s.g_max) s.g_max = magnitude[j];
+        }
+    }
+
+    // Seconde passe : pipeline complet, écrit ligne par ligne
+    row_reader_rewind(&s.reader);
+    s.grey.next = 0;
+    s.blur.next = 0;
+    s.magnitude.next = 0;
+    s.direction.next = 0;
+    s.normalize = true;
+
+    FILE* output = fopen(output_path, "wb");
+    if (output == NULL) log_fatal("Erreur lors de l'ouverture du fichier de sortie : %s", output_path);
+    fprintf(output, "P5\n%d %d\n255\n", s.cols, s.rows);
+
+    int* column = (int*) malloc(sizeof(int) * s.cols);
+    pixel_t* eroded = (pixel_t*) malloc(sizeof(pixel_t) * s.cols);
+    unsigned char* bytes = (unsigned char*) malloc(sizeof(unsigned char) * s.cols);
+    for (int i = 0; i < s.rows; i++) {
+        int top = i - s.mean > 0 ? i - s.mean : 0;
+        int bottom = i + s.mean < s.rows - 1 ? i + s.mean : s.rows - 1;
+        pixel_t* neighbours[bottom - top + 1];
+        stream_dilated_row(&s, bottom, column);
+        for (int x = top; x <= bottom; x++) {
+            neighbours[x - top] = stream_dilated_row(&s, x, column);
+        }
+        stream_morpho_row(neighbours, bottom - top + 1, stream_dilated_row(&s, i, column), s.cols, s.mean,
+                          false, column, eroded);
+        for (int j = 0; j < s.cols; j++) {
+            bytes[j] = (unsigned char) (eroded[j] * 255.0);
+        }
+        fwrite(bytes, 1, s.cols, output);
+    }
+    fclose(output);
+
+    // Libérer les ressources
+    free(column);
+    free(eroded);
+    free(bytes);
+    free(s.saved);
+    free(s.window);
+    row_ring_free(s.grey);
+    row_ring_free(s.blur);
+    row_ring_free(s.magnitude);
+    row_ring_free(s.direction);
+    row_ring_free(s.threshold);
+    row_ring_free(s.edges);
+    row_ring_free(s.dilated);
+    kernel_free(s.gaussian);
+    kernel_free(s.sobel_x);
+    kernel_free(s.sobel_y);
+    row_reader_close(&s.reader);
+
+    log_debug("Filtre de Canny par bandes appliqué, contours écrits dans : %s", output_path);
+}
@@ -0,0 +1,46 @@
+#ifndef CANNY_STREAM_H
+#define CANNY_STREAM_H
+
+#include <stdio.h>
+
+#include "image.h"
+
+// Nombre de lignes par défaut d'une bande
+#define CANNY_STREAM_STRIP_ROWS 64
+
+// Nombre de lignes de recouvrement entre deux bandes pour l'hystérésis
+#define CANNY_STREAM_CARRY_ROWS 16
+
+// Lecteur d'image ligne par ligne (PNM binaire en flux, sinon image décodée en 8 bits)
+struct row_reader_s {
+    FILE* file;             // Fichier PNM ouvert (NULL si repli sur OpenCV)
+    long data_offset;       // Position du début des pixels dans le fichier
+    cv::Mat mat;            // Image décodée par OpenCV (repli pour les autres formats)
+    int rows;
+    int cols;
+    int channels;           // 1 (P5) ou 3 (P6 / OpenCV)
+    int strip_rows;         // Nombre de lignes lues à la fois
+    int strip_start;        // Première ligne présente dans la bande
+    int strip_len;          // Nombre de lignes présentes dans la bande
+    unsigned char* strip;   // Bande d'octets lue depuis le fichier
+};
+typedef struct row_reader_s row_reader_t;
+
+// Ouvrir un lecteur de lignes sur une image
+row_reader_t row_reader_open(const char* path, int strip_rows);
+
+// Revenir au début de l'image
+void row_reader_rewind(row_reader_t* reader);
+
+// Lire la ligne suivante en niveaux de gris (les lignes sont lues dans l'ordre)
+void row_reader_read(row_reader_t* reader, int i, pixel_t* row);
+
+// Fermer un lecteur de lignes
+void row_reader_close(row_reader_t* reader);
+
+// Appliquer le filtre de Canny puis la fermeture morphologique par bandes horizontales,
+// l'image de contours est écrite au fur et à mesure dans output_path (PGM binaire)
+void canny_stream(const char* input_path, const char* output_path,
+                  double t_max, double t_min, int closing_size, int strip_rows);
+
+#endif // CANNY_STREAM_H
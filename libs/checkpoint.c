@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "checkpoint.h"
+#include "crowd.h"
+#include "movement_list.h"
+#include "logging.h"
+#include "common.h"
+
+int CHECKPOINT_INTERVAL = 0; // Pas de point de reprise par défaut
+
+#define CHECKPOINT_MAGIC "CCROWD\0"
+#define CHECKPOINT_VERSION 3
+#define CHECKPOINT_ALIGN 64
+
+// Compteur d'agents du routage en cours
+struct checkpoint_counter_s {
+    int compression;
+    long long agents;
+};
+typedef struct checkpoint_counter_s checkpoint_counter_t;
+
+checkpoint_counter_t checkpoint_counter;
+
+// Arrondir une position au multiple de CHECKPOINT_ALIGN supérieur
+long long checkpoint_align(long long offset) {
+    return (offset + CHECKPOINT_ALIGN - 1) / CHECKPOINT_ALIGN * CHECKPOINT_ALIGN;
+}
+
+// Compléter le fichier avec des zéros jusqu'à une position
+void checkpoint_pad(FILE* file, long long offset) {
+    while (ftell(file) < offset) fputc(0, file);
+}
+
+// Ecrire un point de reprise (remplacement atomique du fichier)
+bool checkpoint_write(const char* path, const routing_state_t* state, environment_t* env, int compression) {
+    log_debug("Ecriture du point de reprise %s", path);
+    long long cells = (long long) env->rows * env->cols;
+    int count = (state->movements != NULL) ? ml_remaining(state->movements) : 0;
+
+    checkpoint_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.rows = env->rows;
+    header.cols = env->cols;
+    header.max = env->max;
+    header.compression = compression;
+    header.weight0 = state->weight0;
+    header.alpha = state->alpha;
+    header.modulo = state->modulo;
+    header.iteration = state->iteration;
+    header.movements = count;
+    header.agents_offset = checkpoint_align(sizeof(header));
+    header.heuristic_offset = checkpoint_align(header.agents_offset + cells * sizeof(int));
+    header.movements_offset = checkpoint_align(header.heuristic_offset + cells * sizeof(double));
+    header.size = header.movements_offset + (long long) count * sizeof(movement_t);
+
+    // Le fichier n'est remplacé qu'une fois complet
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "wb");
+    if (file == NULL) {
+        log_error("Erreur lors de l'ouverture du point de reprise : %s", temporary);
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    checkpoint_pad(file, header.agents_offset);
+    fwrite(env->agents[0], sizeof(int), cells, file);
+    checkpoint_pad(file, header.heuristic_offset);
+    for (int i = 0; i < env->rows; i++) {
+        fwrite(heuristique[i], sizeof(double), env->cols, file);
+    }
+    checkpoint_pad(file, header.movements_offset);
+    // Le mouvement en cours est le premier restant
+    if (count > 0) fwrite(ml_get(state->movements), sizeof(movement_t), count, file);
+    bool written = !ferror(file);
+    if (fclose(file) != 0 || !written || rename(temporary, path) != 0) {
+        log_error("Erreur lors de l'écriture du point de reprise : %s", path);
+        remove(temporary);
+        return false;
+    }
+    log_debug("Point de reprise écrit : %s", path);
+    return true;
+}
+
+// Appelée après chaque agent routé
+void checkpoint_agent_hook(const routing_state_t* state, environment_t* env, void* data) {
+    checkpoint_counter_t* counter = (checkpoint_counter_t*) data;
+    counter->agents++;
+    if (CHECKPOINT_INTERVAL > 0 && counter->agents % CHECKPOINT_INTERVAL == 0) {
+        if (checkpoint_write(CHECKPOINT_OUTPUT, state, env, counter->compression)) {
+            log_info("Point de reprise écrit après %lld agents", counter->agents);
+        }
+    }
+}
+
+// Ecrire un point de reprise tous les CHECKPOINT_INTERVAL agents pendant le routage itératif
+void checkpoint_enable(int compression) {
+    checkpoint_counter = (checkpoint_counter_t) {.compression = compression, .agents = 0};
+    crowd_add_agent_hook(checkpoint_agent_hook, &checkpoint_counter);
+}
+
+// Projeter un point de reprise en mémoire
+checkpoint_t checkpoint_open(const char* path) {
+    log_debug("Lecture du point de reprise %s", path);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) log_fatal("Erreur lors de l'ouverture du point de reprise : %s", path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(checkpoint_header_t)) {
+        log_fatal("Point de reprise invalide : %s", path);
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) log_fatal("Erreur lors de la projection du point de reprise : %s", path);
+
+    const checkpoint_header_t* header = (const checkpoint_header_t*) map;
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0
+            || header->version != CHECKPOINT_VERSION || header->size != st.st_size) {
+        log_fatal("Point de reprise invalide : %s", path);
+    }
+
+    checkpoint_t checkpoint = {
+        .header = header,
+        .agents = (const int*) ((const char*) map + header->agents_offset),
+        .heuristic = (const double*) ((const char*) map + header->heuristic_offset),
+        .movements = (const movement_t*) ((const char*) map + header->movements_offset),
+        .map = map,
+        .size = st.st_size
+    };
+    log_debug("Point de reprise lu : %d x %d, %d mouvements restants", header->rows, header->cols,
+              header->movements);
+    return checkpoint;
+}
+
+// Libérer la projection d'un point de reprise
+void checkpoint_close(checkpoint_t* checkpoint) {
+    munmap(checkpoint->map, checkpoint->size);
+    checkpoint->map = NULL;
+}
+
+// Reconstruire l'environnement d'un point de reprise
+environment_t checkpoint_environment(const checkpoint_t* checkpoint) {
+    environment_t env = env_alloc(checkpoint->header->rows, checkpoint->header->cols);
+    memcpy(env.agents[0], checkpoint->agents, sizeof(int) * env.rows * env.cols);
+    env.max = checkpoint->header->max;
+    return env;
+}
+
+// Recopier l'heuristique dans les tableaux du fil courant (initialisés avec env_initialiser_tableaux)
+void checkpoint_restore_heuristic(const checkpoint_t* checkpoint) {
+    int cols = checkpoint->header->cols;
+    for (int i = 0; i < checkpoint->header->rows; i++) {
+        memcpy(heuristique[i], checkpoint->heuristic + (long long) i * cols, sizeof(double) * cols);
+    }
+}
+
+// Reconstruire la liste des mouvements restants
+movement_list_t* checkpoint_movements(const checkpoint_t* checkpoint) {
+    movement_list_t* movements = ml_create(checkpoint->header->movements);
+    for (int k = 0; k < checkpoint->header->movements; k++) {
+        ml_add(movements, checkpoint->movements[k]);
+    }
+    return movements;
+}
@@ -0,0 +1,68 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+
+#include "crowd.h"
+#include "movement_list.h"
+#include "common.h"
+
+// Nombre d'agents routés entre deux points de reprise (0 = désactivé)
+extern int CHECKPOINT_INTERVAL;
+
+// Fichier écrit pendant le routage
+#define CHECKPOINT_OUTPUT "checkpoint.bin"
+
+// En-tête d'un point de reprise, suivi des sections dont les positions sont données en octets
+struct checkpoint_header_s {
+    char magic[8];
+    int version;
+    int rows;
+    int cols;
+    int max;
+    int compression;
+    int weight0;
+    int alpha;
+    int modulo;
+    int iteration;              // Agents du premier mouvement déjà routés
+    int movements;              // Mouvements restants, celui en cours compris
+    long long agents_offset;    // rows * cols int : congestion
+    long long heuristic_offset; // rows * cols double : heuristique courante
+    long long movements_offset; // movements movement_t, dans l'ordre de traitement
+    long long size;             // Taille totale du fichier
+};
+typedef struct checkpoint_header_s checkpoint_header_t;
+
+// Point de reprise projeté en mémoire (lecture seule)
+struct checkpoint_s {
+    const checkpoint_header_t* header;
+    const int* agents;
+    const double* heuristic;
+    const movement_t* movements;
+    void* map;
+    long long size;
+};
+typedef struct checkpoint_s checkpoint_t;
+
+// Ecrire un point de reprise (remplacement atomique du fichier)
+bool checkpoint_write(const char* path, const routing_state_t* state, environment_t* env, int compression);
+
+// Ecrire un point de reprise tous les CHECKPOINT_INTERVAL agents pendant le routage itératif
+void checkpoint_enable(int compression);
+
+// Projeter un point de reprise en mémoire
+checkpoint_t checkpoint_open(const char* path);
+
+// Libérer la projection d'un point de reprise
+void checkpoint_close(checkpoint_t* checkpoint);
+
+// Reconstruire l'environnement d'un point de reprise
+environment_t checkpoint_environment(const checkpoint_t* checkpoint);
+
+// Recopier l'heuristique dans les tableaux du fil courant (initialisés avec env_initialiser_tableaux)
+void checkpoint_restore_heuristic(const checkpoint_t* checkpoint);
+
+// Reconstruire la liste des mouvements restants
+movement_list_t* checkpoint_movements(const checkpoint_t* checkpoint);
+
+#endif
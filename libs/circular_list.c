@@ -2,6 +2,7 @@
 #include <stdbool.h>
 
 #include "circular_list.h"
+#include "instrument.h"
 
 // Créer une liste circulaire
 circular_list_t* cl_create() {
@@ -14,6 +15,8 @@ circular_list_t* cl_create() {
 // Ajouter un élément à la liste circulaire (placé en tête)
 void cl_add(circular_list_t* cl, void* value) {
     circular_list_node_t* node = (circular_list_node_t*) malloc(sizeof(circular_list_node_t));
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, sizeof(circular_list_node_t));
     node->value = value;
 
     if (cl_is_empty(cl)) {
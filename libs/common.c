@@ -2,10 +2,13 @@
 
 #include "common.h"
 
-position_t** pred = NULL;
-double** dis = NULL;
-double** heuristique = NULL;
-int** heuristique_propagation = NULL;
-int** heuristique_in_queue = NULL;
-int** visited = NULL;
-position_t*** ptrs = NULL;
\ No newline at end of file
+int CONNECTIVITY = 4;
+int ANY_ANGLE = 0;
+
+thread_local position_t** pred = NULL;
+thread_local double** dis = NULL;
+thread_local double** heuristique = NULL;
+thread_local int** heuristique_propagation = NULL;
+thread_local int** heuristique_in_queue = NULL;
+thread_local int** visited = NULL;
+thread_local position_t*** ptrs = NULL;
\ No newline at end of file
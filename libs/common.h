@@ -1,32 +1,107 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <math.h>
+
 
 typedef struct position_s {
     int i;
     int j;
 } position_t;
 
+// Un mouvement part d'une zone rectangulaire et arrive dans une autre ; start et target en sont les coins
+// supérieurs gauches, et une étendue nulle (cas par défaut) donne un point
 struct movement_s {
     position_t start;
     position_t target;
     int agents;
+    position_t start_span;   // Lignes et colonnes de la zone de départ au-delà de start
+    position_t target_span;  // Lignes et colonnes de la zone d'arrivée au-delà de target
+    int departure;           // Pas de temps du départ du premier agent (routage temporel)
 };
 typedef struct movement_s movement_t;
 
-// Directions possibles
-const int directions[4][2] = {
-    {-1, 0}, {1, 0}, {0, -1}, {0, 1}, // Haut, Bas, Gauche, Droite
+// Tester si une case appartient à une zone (coin supérieur gauche et étendue)
+static inline bool region_contains(position_t corner, position_t span, int i, int j) {
+    return i >= corner.i && i <= corner.i + span.i && j >= corner.j && j <= corner.j + span.j;
+}
+
+// Parcours des cases d'une zone limitée à une grille rows x cols, ligne après ligne. Un point est toujours
+// accepté, les murs d'une zone (agents à -1) sont ignorés
+struct region_cells_s {
+    int i;
+    int j;
+    int first_j;
+    int last_i;
+    int last_j;
+    bool point;
+};
+typedef struct region_cells_s region_cells_t;
+
+// Commencer le parcours d'une zone
+static inline region_cells_t region_cells(position_t corner, position_t span, int rows, int cols) {
+    region_cells_t cells;
+    cells.point = span.i == 0 && span.j == 0;
+    cells.i = (corner.i > 0) ? corner.i : 0;
+    cells.first_j = (corner.j > 0) ? corner.j : 0;
+    cells.j = cells.first_j;
+    cells.last_i = (corner.i + span.i < rows) ? corner.i + span.i : rows - 1;
+    cells.last_j = (corner.j + span.j < cols) ? corner.j + span.j : cols - 1;
+    return cells;
+}
+
+// Case suivante de la zone dans cell ; false lorsque le parcours est terminé
+static inline bool region_cells_next(region_cells_t* cells, int** agents, position_t* cell) {
+    while (cells->i <= cells->last_i) {
+        if (cells->j > cells->last_j) {
+            cells->i++;
+            cells->j = cells->first_j;
+            continue;
+        }
+        int j = cells->j++;
+        if (!cells->point && agents[cells->i][j] == -1) continue;
+        *cell = (position_t) {.i = cells->i, .j = j};
+        return true;
+    }
+    return false;
+}
+
+// Nombre de directions utilisées par les recherches : 4 (par défaut) ou 8 avec les diagonales
+extern int CONNECTIVITY;
+
+// Chemins quelconques (Theta*) : une case peut avoir pour prédécesseur toute case en vue directe
+extern int ANY_ANGLE;
+
+// Directions possibles (les CONNECTIVITY premières sont utilisées)
+const int directions[8][2] = {
+    {-1, 0}, {1, 0}, {0, -1}, {0, 1},   // Haut, Bas, Gauche, Droite
+    {-1, -1}, {-1, 1}, {1, -1}, {1, 1}, // Diagonales
 };
 
-// Tableaux
-extern position_t** pred;
-extern double** dis;
-extern double** heuristique;
-extern int** heuristique_propagation;
-extern int** heuristique_in_queue;
-extern int** visited;
-extern position_t*** ptrs;
+// Longueur d'un déplacement dans chaque direction
+const double direction_lengths[8] = {1., 1., 1., 1., 1.4142135623730951, 1.4142135623730951,
+                                     1.4142135623730951, 1.4142135623730951};
+
+// Distance minorant le nombre de pas (pondéré par leur longueur) pour un écart (di, dj) : norme 1 en
+// 4-connexité, distance octile en 8-connexité, distance euclidienne pour les chemins quelconques
+static inline double grid_distance(int di, int dj) {
+    di = (di < 0) ? -di : di;
+    dj = (dj < 0) ? -dj : dj;
+    if (ANY_ANGLE) return sqrt((double) di * di + (double) dj * dj);
+    if (CONNECTIVITY != 8) return di + dj;
+    int low = (di < dj) ? di : dj;
+    int high = (di < dj) ? dj : di;
+    return high + 0.41421356237309515 * low;
+}
+
+// Tableaux (un jeu par fil d'exécution, chaque fil les initialise avec env_initialiser_tableaux)
+extern thread_local position_t** pred;
+extern thread_local double** dis;
+extern thread_local double** heuristique;
+extern thread_local int** heuristique_propagation;
+extern thread_local int** heuristique_in_queue;
+extern thread_local int** visited;
+extern thread_local position_t*** ptrs;
 
 
 #endif
\ No newline at end of file
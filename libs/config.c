@@ -1,6 +1,22 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "config.h"
+#include "parallel.h"
+#include "pyramid.h"
+#include "batch.h"
+#include "checkpoint.h"
+#include "planner.h"
+#include "timed.h"
+#include "common.h"
+#include "snapshot.h"
+#include "congestion.h"
+#include "crowd.h"
+#include "cost.h"
+#include "equilibrium.h"
+#include "heuristic.h"
+#include "path_cache.h"
+#include "logging.h"
 
 int DEBUG_MODE = 0; // Mode de débogage par défaut
 
@@ -11,7 +27,80 @@ void config_load(const char* filename) {
         fprintf(stderr, "Erreur lors de l'ouverture du fichier de configuration : %s\n", filename);
         return;
     }
-    fscanf(file, "DEBUG_MODE==%d\n", &DEBUG_MODE);
+    // Une clé par ligne : CLE==valeur
+    char key[64];
+    int value;
+    while (fscanf(file, " %63[^=]==%d", key, &value) == 2) {
+        if (strcmp(key, "DEBUG_MODE") == 0) DEBUG_MODE = value;
+        else if (strcmp(key, "PARALLEL_THREADS") == 0) PARALLEL_THREADS = value;
+        else if (strcmp(key, "PYRAMID_LEVELS") == 0) PYRAMID_LEVELS = value;
+        else if (strcmp(key, "PYRAMID_RADIUS") == 0) PYRAMID_RADIUS = value;
+        else if (strcmp(key, "LOG_ASYNC") == 0) LOG_ASYNC = value;
+        else if (strcmp(key, "BATCH_CACHE_SIZE") == 0) BATCH_CACHE_SIZE = value;
+        else if (strcmp(key, "CHECKPOINT_INTERVAL") == 0) CHECKPOINT_INTERVAL = value;
+        else if (strcmp(key, "PLANNER") == 0) PLANNER = value;
+        else if (strcmp(key, "PLANNER_ROUND") == 0) PLANNER_ROUND = value;
+        else if (strcmp(key, "TIME_WINDOW") == 0) TIME_WINDOW = value;
+        else if (strcmp(key, "TIME_BUCKET") == 0) TIME_BUCKET = value;
+        else if (strcmp(key, "TIME_SPACING") == 0) TIME_SPACING = value;
+        else if (strcmp(key, "CONNECTIVITY") == 0) CONNECTIVITY = value;
+        else if (strcmp(key, "ANY_ANGLE") == 0) ANY_ANGLE = value;
+        else if (strcmp(key, "COST_MODEL") == 0) COST_MODEL = value;
+        else if (strcmp(key, "COST_CAPACITY") == 0) COST_CAPACITY = value;
+        else if (strcmp(key, "COST_POWER") == 0) COST_POWER = value;
+        else if (strcmp(key, "SEARCH_QUEUE") == 0) SEARCH_QUEUE = value;
+        else if (strcmp(key, "SEARCH_HEURISTIC") == 0) SEARCH_HEURISTIC = value;
+        else if (strcmp(key, "HEURISTIC_BUILDER") == 0) HEURISTIC_BUILDER = value;
+        else if (strcmp(key, "PATH_CACHE") == 0) PATH_CACHE = value;
+        else if (strcmp(key, "PATH_CACHE_TOLERANCE") == 0) PATH_CACHE_TOLERANCE = value;
+        else if (strcmp(key, "EQUILIBRIUM_ITERATIONS") == 0) EQUILIBRIUM_ITERATIONS = value;
+        else if (strcmp(key, "EQUILIBRIUM_METHOD") == 0) EQUILIBRIUM_METHOD = value;
+        else if (strcmp(key, "EQUILIBRIUM_GAP") == 0) EQUILIBRIUM_GAP = value;
+        else if (strcmp(key, "SNAPSHOT_INTERVAL") == 0) SNAPSHOT_INTERVAL = value;
+        else if (strcmp(key, "SNAPSHOT_SECONDS") == 0) SNAPSHOT_SECONDS = value;
+        else if (strcmp(key, "SNAPSHOT_VIDEO") == 0) SNAPSHOT_VIDEO = value;
+        else if (strcmp(key, "SNAPSHOT_REDUCED") == 0) SNAPSHOT_REDUCED = value;
+        else if (strcmp(key, "CONGESTION_OUTPUT") == 0) CONGESTION_OUTPUT = value;
+        else fprintf(stderr, "Clé de configuration inconnue : %s\n", key);
+    }
     fclose(file);
+    if (CONNECTIVITY != 4 && CONNECTIVITY != 8) {
+        fprintf(stderr, "Connexité invalide : %d (4 ou 8), 4 utilisée\n", CONNECTIVITY);
+        CONNECTIVITY = 4;
+    }
+    if (HEURISTIC_BUILDER != HEURISTIC_BUILDER_SEARCH && HEURISTIC_BUILDER != HEURISTIC_BUILDER_SWEEP) {
+        fprintf(stderr, "Construction de l'heuristique invalide : %d (0 ou 1), 0 utilisée\n", HEURISTIC_BUILDER);
+        HEURISTIC_BUILDER = HEURISTIC_BUILDER_SEARCH;
+    }
+    if (HEURISTIC_BUILDER == HEURISTIC_BUILDER_SWEEP && ANY_ANGLE) {
+        fprintf(stderr, "Balayages incompatibles avec ANY_ANGLE, recherche inverse utilisée\n");
+        HEURISTIC_BUILDER = HEURISTIC_BUILDER_SEARCH;
+    }
+    if (PATH_CACHE_TOLERANCE < 0) {
+        fprintf(stderr, "Tolérance du cache de chemins invalide : %d, 0 utilisée\n", PATH_CACHE_TOLERANCE);
+        PATH_CACHE_TOLERANCE = 0;
+    }
+    if (COST_MODEL < COST_MODEL_LINEAR || COST_MODEL > COST_MODEL_TABLE) {
+        fprintf(stderr, "Modèle de coût invalide : %d (0 à 4), 0 utilisé\n", COST_MODEL);
+        COST_MODEL = COST_MODEL_LINEAR;
+    }
+    if (COST_MODEL == COST_MODEL_TABLE && !cost_load_table(COST_TABLE_FILE)) {
+        fprintf(stderr, "Table de coûts illisible : %s, modèle linéaire utilisé\n", COST_TABLE_FILE);
+        COST_MODEL = COST_MODEL_LINEAR;
+    }
+    // Les seaux trient des priorités entières : coûts linéaires et pas unitaires seulement
+    if (SEARCH_QUEUE == SEARCH_QUEUE_BUCKETS && (COST_MODEL != COST_MODEL_LINEAR || CONNECTIVITY != 4 || ANY_ANGLE)) {
+        fprintf(stderr, "File à seaux réservée aux priorités entières, tas binaire utilisé\n");
+        SEARCH_QUEUE = SEARCH_QUEUE_HEAP;
+    }
+    if (COST_CAPACITY <= 0) {
+        fprintf(stderr, "Capacité invalide : %d, 10 utilisée\n", COST_CAPACITY);
+        COST_CAPACITY = 10;
+    }
+    if (COST_POWER < 1) {
+        fprintf(stderr, "Exposant invalide : %d, 4 utilisé\n", COST_POWER);
+        COST_POWER = 4;
+    }
     fprintf(stderr, "debug mode : %d\n", DEBUG_MODE);
+    if (LOG_ASYNC) log_async_start();
 }
\ No newline at end of file
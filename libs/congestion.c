@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "congestion.h"
+#include "crowd.h"
+#include "logging.h"
+#include "common.h"
+
+int CONGESTION_OUTPUT = 0; // Pas de sortie binaire par défaut
+
+// Format : en-tête CONGESTION_MAGIC, lignes et colonnes (entiers variables), puis des enregistrements
+// 'P' (chemin) au fil du routage, un enregistrement 'G' (grille) et 'E' (fin)
+//   'P' : ligne et colonne de départ, nombre de pas, puis les directions (indices de directions, deux par
+//         octet, poids faible d'abord) du départ vers l'arrivée
+//   'G' : maximum, puis des plages (longueur, valeur) couvrant la grille ligne après ligne
+// Les entiers sont écrits sur un nombre variable d'octets (7 bits par octet, les négatifs en zigzag)
+#define CONGESTION_MAGIC "CCGRID01"
+
+// Fichier en cours d'écriture
+struct congestion_writer_s {
+    FILE* file;
+    long long paths;
+    long long path_cells;
+    unsigned char* steps;       // Directions du chemin en cours
+    int capacity;
+};
+typedef struct congestion_writer_s congestion_writer_t;
+
+congestion_writer_t congestion_writer = {.file = NULL};
+
+// Ecrire un entier positif sur un nombre variable d'octets
+void congestion_put_varint(FILE* file, unsigned long long value) {
+    while (value >= 0x80) {
+        fputc((int) (value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int) value, file);
+}
+
+// Ecrire un entier signé (zigzag : 0, -1, 1, -2... deviennent 0, 1, 2, 3...)
+void congestion_put_signed(FILE* file, long long value) {
+    congestion_put_varint(file, ((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63));
+}
+
+// Lire un entier positif ; renvoie false en fin de fichier
+bool congestion_get_varint(FILE* file, unsigned long long* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        *value |= (unsigned long long) (c & 0x7f) << shift;
+        if ((c & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Lire un entier signé
+bool congestion_get_signed(FILE* file, long long* value) {
+    unsigned long long raw;
+    if (!congestion_get_varint(file, &raw)) return false;
+    *value = (long long) (raw >> 1) ^ -(long long) (raw & 1);
+    return true;
+}
+
+// Indice de la direction menant de a à b (cases voisines), -1 sinon
+int congestion_direction(position_t a, position_t b) {
+    for (int d = 0; d < 8; d++) {
+        if (a.i + directions[d][0] == b.i && a.j + directions[d][1] == b.j) return d;
+    }
+    return -1;
+}
+
+// Ecrire un chemin (cases de l'arrivée au départ) sous forme de chaîne de directions
+void congestion_write_path(congestion_writer_t* writer, const position_t* path, int length) {
+    if (length == 0) return;
+    int steps = length - 1;
+    if ((steps + 1) / 2 > writer->capacity) {
+        writer->capacity = (steps + 1) / 2;
+        writer->steps = (unsigned char*) realloc(writer->steps, writer->capacity);
+    }
+    memset(writer->steps, 0, (steps + 1) / 2);
+    for (int k = 0; k < steps; k++) {
+        // Le chemin est parcouru du départ (dernière case) vers l'arrivée
+        int d = congestion_direction(path[length - 1 - k], path[length - 2 - k]);
+        if (d < 0) {
+            log_debug("Chemin non contigu ignoré dans la sortie de congestion");
+            return;
+        }
+        writer->steps[k / 2] |= (unsigned char) (d << (4 * (k % 2)));
+    }
+    fputc('P', writer->file);
+    congestion_put_varint(writer->file, path[length - 1].i);
+    congestion_put_varint(writer->file, path[length - 1].j);
+    congestion_put_varint(writer->file, steps);
+    fwrite(writer->steps, 1, (steps + 1) / 2, writer->file);
+    writer->paths++;
+    writer->path_cells += length;
+}
+
+// Appelée après chaque agent routé
+void congestion_agent_hook(const routing_state_t* state, environment_t* env, void* data) {
+    congestion_writer_t* writer = (congestion_writer_t*) data;
+    congestion_write_path(writer, state->path, state->path_length);
+}
+
+// Commencer l'écriture d'un fichier de congestion ; avec paths, les chemins du A* itératif y sont ajoutés
+// au fil du routage
+bool congestion_open(const char* path, environment_t* env, bool paths) {
+    if (congestion_writer.file != NULL) return false;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        log_error("Erreur lors de l'ouverture du fichier de congestion : %s", path);
+        return false;
+    }
+    fwrite(CONGESTION_MAGIC, 1, 8, file);
+    congestion_put_varint(file, env->rows);
+    congestion_put_varint(file, env->cols);
+    congestion_writer = (congestion_writer_t) {.file = file, .paths = 0, .path_cells = 0, .steps = NULL,
+                                               .capacity = 0};
+    if (paths) crowd_add_agent_hook(congestion_agent_hook, &congestion_writer);
+    return true;
+}
+
+// Terminer le fichier avec la grille finale
+void congestion_close(environment_t* env) {
+    congestion_writer_t* writer = &congestion_writer;
+    if (writer->file == NULL) return;
+    crowd_remove_agent_hook(congestion_agent_hook, writer);
+
+    // Plages de valeurs identiques, la grille étant contiguë
+    fputc('G', writer->file);
+    congestion_put_varint(writer->file, env->max);
+    long long cells = (long long) env->rows * env->cols;
+    const int* values = env->agents[0];
+    long long runs = 0;
+    for (long long c = 0; c < cells; ) {
+        long long end = c + 1;
+        while (end < cells && values[end] == values[c]) end++;
+        congestion_put_varint(writer->file, end - c);
+        congestion_put_signed(writer->file, values[c]);
+        runs++;
+        c = end;
+    }
+    fputc('E', writer->file);
+    long long size = ftell(writer->file);
+    if (fclose(writer->file) != 0) log_error("Erreur lors de l'écriture du fichier de congestion");
+    log_info("Congestion : %lld octets (%lld plages, %lld chemins) au lieu de %lld pour la grille brute", size,
+             runs, writer->paths, cells * (long long) sizeof(int));
+    free(writer->steps);
+    *writer = (congestion_writer_t) {.file = NULL};
+}
+
+// Lire un fichier de congestion ; cells (s'il n'est pas NULL) reçoit les cases empruntées au format CSV
+// (i;j;agents) et paths les chemins (un par ligne, cases i:j séparées par des espaces)
+bool congestion_read(const char* path, congestion_file_t* result, FILE* cells, FILE* paths) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+    char magic[8];
+    unsigned long long rows, cols;
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, CONGESTION_MAGIC, 8) != 0
+            || !congestion_get_varint(file, &rows) || !congestion_get_varint(file, &cols)
+            || rows == 0 || cols == 0 || rows * cols > (1ULL << 32)) {
+        log_error("Fichier de congestion invalide : %s", path);
+        fclose(file);
+        return false;
+    }
+    result->env = env_alloc((int) rows, (int) cols);
+    result->paths = 0;
+    result->path_cells = 0;
+
+    bool valid = false;
+    int tag;
+    while ((tag = fgetc(file)) != EOF) {
+        if (tag == 'E') {
+            valid = true;
+            break;
+        }
+        if (tag == 'P') {
+            unsigned long long i, j, steps;
+            if (!congestion_get_varint(file, &i) || !congestion_get_varint(file, &j)
+                    || !congestion_get_varint(file, &steps)) break;
+            position_t cell = {.i = (int) i, .j = (int) j};
+            if (paths != NULL) fprintf(paths, "%d:%d", cell.i, cell.j);
+            int byte = 0;
+            for (unsigned long long k = 0; k < steps; k++) {
+                if (k % 2 == 0 && (byte = fgetc(file)) == EOF) break;
+                int d = (byte >> (4 * (k % 2))) & 0x0f;
+                cell.i += directions[d & 7][0];
+                cell.j += directions[d & 7][1];
+                if (paths != NULL) fprintf(paths, " %d:%d", cell.i, cell.j);
+            }
+            if (paths != NULL) fputc('\n', paths);
+            if (byte == EOF) break;
+            result->paths++;
+            result->path_cells += steps + 1;
+        }
+        else if (tag == 'G') {
+            unsigned long long max;
+            if (!congestion_get_varint(file, &max)) break;
+            result->env.max = (int) max;
+            long long total = (long long) rows * cols;
+            int* values = result->env.agents[0];
+            long long c = 0;
+            while (c < total) {
+                unsigned long long length;
+                long long value;
+                if (!congestion_get_varint(file, &length) || !congestion_get_signed(file, &value)
+                        || length == 0 || c + (long long) length > total) break;
+                for (unsigned long long k = 0; k < length; k++) values[c++] = (int) value;
+            }
+            if (c != total) break;
+        }
+        else {
+            break;
+        }
+    }
+    result->size = ftell(file);
+    fclose(file);
+    if (!valid) {
+        log_error("Fichier de congestion tronqué ou invalide : %s", path);
+        env_free(result->env);
+        return false;
+    }
+
+    if (cells != NULL) {
+        fprintf(cells, "i;j;agents\n");
+        for (int i = 0; i < result->env.rows; i++) {
+            for (int j = 0; j < result->env.cols; j++) {
+                if (result->env.agents[i][j] > 0) fprintf(cells, "%d;%d;%d\n", i, j, result->env.agents[i][j]);
+            }
+        }
+    }
+    return true;
+}
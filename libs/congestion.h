@@ -0,0 +1,35 @@
+#ifndef CONGESTION_H
+#define CONGESTION_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "crowd.h"
+
+// Sortie binaire de la congestion : 0 = aucune (par défaut), 1 = grille, 2 = grille et chemins
+extern int CONGESTION_OUTPUT;
+
+// Fichier écrit par le programme principal
+#define CONGESTION_OUTPUT_FILE "pictures/congestion.ccg"
+
+// Contenu d'un fichier de congestion
+struct congestion_file_s {
+    environment_t env;          // Grille finale (-1 pour les murs)
+    long long paths;            // Chemins enregistrés
+    long long path_cells;       // Cases de ces chemins
+    long long size;             // Taille du fichier en octets
+};
+typedef struct congestion_file_s congestion_file_t;
+
+// Commencer l'écriture d'un fichier de congestion ; avec paths, les chemins du A* itératif y sont ajoutés
+// au fil du routage
+bool congestion_open(const char* path, environment_t* env, bool paths);
+
+// Terminer le fichier avec la grille finale
+void congestion_close(environment_t* env);
+
+// Lire un fichier de congestion ; cells (s'il n'est pas NULL) reçoit les cases empruntées au format CSV
+// (i;j;agents) et paths les chemins (un par ligne, cases i:j séparées par des espaces)
+bool congestion_read(const char* path, congestion_file_t* result, FILE* cells, FILE* paths);
+
+#endif
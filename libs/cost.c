@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "cost.h"
+#include "logging.h"
+#include "instrument.h"
+
+int COST_MODEL = COST_MODEL_LINEAR;
+int COST_CAPACITY = 10;
+int COST_POWER = 4;
+
+// Coûts lus pour COST_MODEL_TABLE
+double* cost_user = NULL;
+int cost_user_size = 0;
+
+// Lire les coûts de COST_MODEL_TABLE
+bool cost_load_table(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        log_error("Erreur lors de l'ouverture de la table de coûts : %s", path);
+        return false;
+    }
+    int capacity = 64;
+    double* values = (double*) malloc(sizeof(double) * capacity);
+    int size = 0;
+    double value;
+    while (fscanf(file, " %lf", &value) == 1) {
+        if (size == capacity) {
+            capacity *= 2;
+            values = (double*) realloc(values, sizeof(double) * capacity);
+        }
+        values[size++] = value;
+    }
+    bool complete = feof(file);
+    fclose(file);
+    if (size == 0 || !complete) {
+        log_error("Table de coûts invalide : %s", path);
+        free(values);
+        return false;
+    }
+    free(cost_user);
+    cost_user = values;
+    cost_user_size = size;
+    log_debug("Table de coûts lue : %d valeurs", size);
+    return true;
+}
+
+// Coût d'une case occupée par k agents selon le modèle courant
+double cost_model_value(const cost_table_t* table, int k) {
+    switch (COST_MODEL) {
+        case COST_MODEL_QUADRATIC:
+            return (double) k * k * table->alpha + table->weight0;
+        case COST_MODEL_CAPACITY:
+            return (double) ((k <= COST_CAPACITY) ? k : k * k / COST_CAPACITY) * table->alpha + table->weight0;
+        case COST_MODEL_POWER:
+            return table->weight0 + (double) table->alpha * COST_CAPACITY * pow((double) k / COST_CAPACITY, COST_POWER);
+        case COST_MODEL_TABLE: {
+            if (k < cost_user_size) return cost_user[k];
+            double step = (cost_user_size > 1) ? cost_user[cost_user_size - 1] - cost_user[cost_user_size - 2] : 0.;
+            return cost_user[cost_user_size - 1] + step * (k - cost_user_size + 1);
+        }
+        default:
+            return (double) k * table->alpha + table->weight0;
+    }
+}
+
+// Etendre la table jusqu'à agents agents ; les coûts sont rendus positifs et croissants, de sorte qu'une
+// distance calculée avec moins d'agents minore toujours la distance actuelle
+void cost_table_reserve(cost_table_t* table, int agents) {
+    if (agents < table->size) return;
+    int size = (2 * table->size > agents) ? 2 * table->size : agents + 1;
+    table->costs = (double*) realloc(table->costs, sizeof(double) * size);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(double) * size);
+    for (int k = table->size; k < size; k++) {
+        double cost = cost_model_value(table, k);
+        double previous = (k > 0) ? table->costs[k - 1] : 0.;
+        table->costs[k] = (cost > previous) ? cost : previous;
+    }
+    table->size = size;
+}
+
+// Précalculer les coûts du modèle courant
+cost_table_t cost_table_create(int weight0, int alpha) {
+    cost_table_t table = {.costs = NULL, .size = 0, .weight0 = weight0, .alpha = alpha, .lower = 0.};
+    cost_table_reserve(&table, 63);
+    table.lower = table.costs[0];
+    return table;
+}
+
+// Libérer une table de coûts
+void cost_table_free(cost_table_t* table) {
+    free(table->costs);
+    table->costs = NULL;
+    table->size = 0;
+}
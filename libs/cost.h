@@ -0,0 +1,55 @@
+#ifndef COST_H
+#define COST_H
+
+#include <stdbool.h>
+
+// Modèles de coût d'une case selon son nombre d'agents
+enum cost_model_e {
+    COST_MODEL_LINEAR,      // agents * alpha + weight0 (par défaut)
+    COST_MODEL_QUADRATIC,   // agents² * alpha + weight0
+    COST_MODEL_CAPACITY,    // Linéaire jusqu'à COST_CAPACITY agents, puis agents² / COST_CAPACITY
+    COST_MODEL_POWER,       // Loi puissance (BPR) : weight0 + alpha * COST_CAPACITY * (agents / COST_CAPACITY)^COST_POWER
+    COST_MODEL_TABLE,       // Coûts lus dans COST_TABLE_FILE
+};
+
+// Modèle de coût des recherches
+extern int COST_MODEL;
+
+// Capacité d'une case pour COST_MODEL_CAPACITY et COST_MODEL_POWER
+extern int COST_CAPACITY;
+
+// Exposant de COST_MODEL_POWER
+extern int COST_POWER;
+
+// Coûts de COST_MODEL_TABLE : un nombre par ligne, pour 0, 1, 2... agents, prolongés au-delà avec le dernier écart
+#define COST_TABLE_FILE "cost_table.csv"
+
+// Coûts d'une case selon son nombre d'agents, précalculés pour un couple (weight0, alpha)
+struct cost_table_s {
+    double* costs;      // costs[k] : coût d'une case occupée par k agents, croissant avec k
+    int size;           // Nombres d'agents couverts (agrandie au besoin)
+    int weight0;
+    int alpha;
+    double lower;       // Plus petit coût d'une case : minore le coût d'un pas de longueur 1 pour les heuristiques
+};
+typedef struct cost_table_s cost_table_t;
+
+// Lire les coûts de COST_MODEL_TABLE
+bool cost_load_table(const char* path);
+
+// Précalculer les coûts du modèle courant
+cost_table_t cost_table_create(int weight0, int alpha);
+
+// Etendre la table jusqu'à agents agents
+void cost_table_reserve(cost_table_t* table, int agents);
+
+// Libérer une table de coûts
+void cost_table_free(cost_table_t* table);
+
+// Coût d'une case occupée par agents agents (la table est étendue au besoin)
+static inline double cost_get(cost_table_t* table, int agents) {
+    if (agents >= table->size) cost_table_reserve(table, agents);
+    return table->costs[agents];
+}
+
+#endif
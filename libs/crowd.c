@@ -1,26 +1,45 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 
 #include "crowd.h"
 #include "image.h"
 #include "image_usage.h"
-#include "circular_list.h"
+#include "movement_list.h"
 #include "logging.h"
 #include "common.h"
+#include "instrument.h"
+#include "priority_queue.h"
+#include "bucket_queue.h"
+#include "cost.h"
+#include "heuristic.h"
+#include "path_cache.h"
+
+// Allouer un environnement vide ; les cases sont contiguës (ligne après ligne) à partir de agents[0]
+environment_t env_alloc(int rows, int cols) {
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) rows * cols * sizeof(int));
+    environment_t env = {
+        .rows = rows,
+        .cols = cols,
+        .agents = (int**) malloc(sizeof(int*) * rows),
+        .max = 0
+    };
+    int* cells = (int*) malloc(sizeof(int) * rows * cols);
+    for (int i = 0; i < rows; i++) {
+        env.agents[i] = cells + i * cols;
+    }
+    return env;
+}
 
 // Créer un environnement à partir d'une image
 environment_t env_from_image(image_t image) {
     log_debug("Création d'un environnement à partir de l'image : %s", image.name);
-
-    environment_t env {
-        .rows = image.rows,
-        .cols = image.cols,
-        .agents = (int**) malloc(sizeof(int*) * env.rows),
-        .max = 0
-    };
+    INSTR_SCOPE(INSTR_STAGE_ENV_FROM_IMAGE);
+    environment_t env = env_alloc(image.rows, image.cols);
     for (int i = 0; i < env.rows; i++) {
-        env.agents[i] = (int*) malloc(sizeof(int) * env.cols);
         for (int j = 0; j < env.cols; j++) {
             if (image.pixels[i][j] == 1.) env.agents[i][j] = -1;
             else env.agents[i][j] = 0;
@@ -35,186 +54,462 @@ environment_t env_from_image(image_t image) {
 void env_free(environment_t env) {
     log_debug("Libération de la mémoire d'un environnement");
 
-    for (int i = 0; i < env.rows; i++) {
-        free(env.agents[i]);
-    }
+    if (env.rows > 0) free(env.agents[0]);
     free(env.agents);
 
     log_debug("Mémoire de l'environnement libérée");
 }
 
-// Modifier une image en fonction de l'environnement
-void env_image_edit(image_t image, environment_t env, int n) {
-    log_debug("Modification de l'image en fonction de l'environnement : %s", image.name);
+// Copier un environnement
+environment_t env_copy(environment_t env) {
+    log_debug("Copie d'un environnement");
+    environment_t copy = env_alloc(env.rows, env.cols);
+    env_copy_into(&copy, env);
+    log_debug("Environnement copié");
+    return copy;
+}
 
-    if (env.max == 0) return;
-    for (int i = 0; i < env.rows; i++) {
-        for (int j = 0; j < env.cols; j++) {
+// Recopier l'état d'un environnement dans un autre de même taille (une seule copie mémoire)
+void env_copy_into(environment_t* copy, environment_t env) {
+    memcpy(copy->agents[0], env.agents[0], sizeof(int) * env.rows * env.cols);
+    copy->max = env.max;
+}
 
-            if (env.agents[i][j] > -1) {
-                pixel_t pix = (double) env.agents[i][j] / (double) env.max;
+int SEARCH_QUEUE = SEARCH_QUEUE_HEAP;
+int SEARCH_HEURISTIC = 1;
 
-                for (int k = 0; k < n; k++) {
-                    if (i * n + k >= image.rows) break;
-                    for (int l = 0; l < n; l++) {
-                        if (j * n + l >= image.cols) break;
-                        image.pixels[i * n + k][j * n + l] = pix;
-                    }
-                }
+// Distance norme 1
+int distance_norme1(position_t p1, position_t p2) {
+    return abs(p1.i - p2.i) + abs(p1.j - p2.j);
+}
+
+#define CROWD_AGENT_HOOKS 8
+
+// Fonctions appelées après chaque agent
+agent_hook_t crowd_agent_hooks[CROWD_AGENT_HOOKS];
+void* crowd_agent_hooks_data[CROWD_AGENT_HOOKS];
+int crowd_agent_hook_count = 0;
+
+// Routage en cours sur ce fil d'exécution
+thread_local routing_state_t routing_state = {.movements = NULL};
+
+// Chemin du dernier agent routé sur ce fil (agrandi au besoin)
+thread_local position_t* crowd_path = NULL;
+thread_local int crowd_path_capacity = 0;
+
+// Ajouter une case au chemin du dernier agent
+void crowd_path_add(position_t cell) {
+    if (routing_state.path_length == crowd_path_capacity) {
+        crowd_path_capacity = (crowd_path_capacity > 0) ? 2 * crowd_path_capacity : 1024;
+        crowd_path = (position_t*) realloc(crowd_path, sizeof(position_t) * crowd_path_capacity);
+    }
+    crowd_path[routing_state.path_length++] = cell;
+    routing_state.path = crowd_path;
+}
+
+// Numéro de la dernière recherche du A* itératif sur ce fil ; visited garde le numéro de la dernière
+// recherche ayant atteint chaque case, qui n'est donc jamais remis à zéro entre deux recherches
+thread_local int crowd_epoch = 0;
+
+// Numéro de la recherche suivante
+int crowd_next_epoch(environment_t* env) {
+    if (crowd_epoch == INT_MAX) {
+        // Dépassement : on repart de zéro après avoir effacé les anciens numéros
+        for (int i = 0; i < env->rows; i++) {
+            for (int j = 0; j < env->cols; j++) {
+                visited[i][j] = -1;
             }
         }
+        crowd_epoch = 0;
     }
-    log_debug("Image modifiée en fonction de l'environnement : %s", image.name);
+    return ++crowd_epoch;
 }
 
-// Modifier une image colorée en fonction de l'environnement
-void env_image_colored_edit(colored_image_t image, environment_t env, int n) {
-    log_debug("Modification de l'image colorée en fonction de l'environnement : %s", image.name);
+// Commencer le tracé de Bresenham du segment de a vers b
+segment_t segment_start(position_t a, position_t b) {
+    int di = abs(b.i - a.i);
+    int dj = abs(b.j - a.j);
+    segment_t segment = {
+        .at = a,
+        .di = di,
+        .dj = -dj,
+        .si = (a.i < b.i) ? 1 : -1,
+        .sj = (a.j < b.j) ? 1 : -1,
+        .error = di - dj,
+        .length = (di > dj) ? di : dj
+    };
+    return segment;
+}
 
-    if (env.max == 0) return;
-    for (int i = 0; i < env.rows; i++) {
-        for (int j = 0; j < env.cols; j++) {
+// Avancer d'une case sur un segment
+void segment_next(segment_t* segment) {
+    int e2 = 2 * segment->error;
+    if (e2 >= segment->dj) {
+        segment->error += segment->dj;
+        segment->at.i += segment->si;
+    }
+    if (e2 <= segment->di) {
+        segment->error += segment->di;
+        segment->at.j += segment->sj;
+    }
+}
 
-            if (env.agents[i][j] > 0) {
-                double alpha = 1. - (double) env.agents[i][j] / (double) env.max;
-                colored_pixel_t pix {
-                    .r = 255. * alpha * alpha * alpha,
-                    .g = 0,
-                    .b = 0
-                };
-
-                for (int k = 0; k < n; k++) {
-                    if (i * n + k >= image.rows) break;
-                    for (int l = 0; l < n; l++) {
-                        if (j * n + l >= image.cols) break;
-                        image.pixels[i * n + k][j * n + l] = pix;
-                    }
-                }
-            }
+// Coût d'une case occupée par agents agents : calculé pour le modèle linéaire, lu dans la table (étendue
+// jusqu'au maximum de l'environnement) pour les autres
+template <bool lookup>
+static inline double crowd_cost(const cost_table_t* costs, int agents, int weight0, int alpha) {
+    if (lookup) return costs->costs[agents];
+    return agents * alpha + weight0;
+}
+
+// Vue directe de a vers b, le coût des cases étant donné par crowd_cost
+template <bool lookup>
+bool crowd_line_of_sight_cost(environment_t* env, position_t a, position_t b, const cost_table_t* costs,
+                              int weight0, int alpha, double* cost) {
+    segment_t segment = segment_start(a, b);
+    double sum = 0.;
+    for (int k = 0; k < segment.length; k++) {
+        position_t from = segment.at;
+        segment_next(&segment);
+        position_t to = segment.at;
+        if (env->agents[to.i][to.j] == -1) return false;
+        if (from.i != to.i && from.j != to.j
+                && (env->agents[from.i][to.j] == -1 || env->agents[to.i][from.j] == -1)) return false;
+        sum += crowd_cost<lookup>(costs, env->agents[to.i][to.j], weight0, alpha);
+    }
+    if (segment.length == 0) {
+        *cost = 0.;
+        return true;
+    }
+    double di = b.i - a.i;
+    double dj = b.j - a.j;
+    *cost = sum * sqrt(di * di + dj * dj) / segment.length;
+    return true;
+}
+
+// Vue directe de a vers b : le segment ne traverse ni mur ni coin de mur. cost reçoit la somme des coûts
+// des cases traversées (a exclue), ramenée à la longueur euclidienne du segment
+bool crowd_line_of_sight(environment_t* env, position_t a, position_t b, int weight0, int alpha, double* cost) {
+    return crowd_line_of_sight_cost<false>(env, a, b, NULL, weight0, alpha, cost);
+}
+
+// Opérations communes aux deux files de la recherche
+static inline void crowd_queue_create(priority_queue_t** queue) { *queue = pq_create(1024); }
+static inline void crowd_queue_create(bucket_queue_t** queue) { *queue = bq_create(1024); }
+static inline void crowd_queue_push(priority_queue_t* queue, double priority, void* value) { pq_push(queue, priority, value); }
+// Priorité tronquée à l'entier, bornée avant la conversion : un long chemin à fort alpha peut dépasser un int
+static inline void crowd_queue_push(bucket_queue_t* queue, double priority, void* value) {
+    bq_push(queue, (priority < BQ_MAX_PRIORITY) ? (int) priority : BQ_MAX_PRIORITY, value);
+}
+static inline void* crowd_queue_pop(priority_queue_t* queue) { return pq_pop(queue); }
+static inline void* crowd_queue_pop(bucket_queue_t* queue) { return bq_pop(queue); }
+static inline bool crowd_queue_is_empty(priority_queue_t* queue) { return pq_is_empty(queue); }
+static inline bool crowd_queue_is_empty(bucket_queue_t* queue) { return bq_is_empty(queue); }
+static inline void crowd_queue_clear(priority_queue_t* queue) { pq_clear(queue); }
+static inline void crowd_queue_clear(bucket_queue_t* queue) { bq_clear(queue); }
+static inline void crowd_queue_free(priority_queue_t* queue) { pq_free(queue); }
+static inline void crowd_queue_free(bucket_queue_t* queue) { bq_free(queue); }
+
+// Placer les cases d'une zone dans la file à distance nulle (voir region_cells)
+template <typename search_queue_t>
+void crowd_push_region(search_queue_t* pq, environment_t* env, position_t corner, position_t span, int epoch) {
+    region_cells_t cells = region_cells(corner, span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        dis[p.i][p.j] = 0.;
+        visited[p.i][p.j] = epoch;
+        pred[p.i][p.j] = p;
+        crowd_queue_push(pq, 0, (void*) ptrs[p.i][p.j]);
+    }
+}
+
+// Ajouter une fonction appelée après chaque agent routé par le A* itératif
+void crowd_add_agent_hook(agent_hook_t hook, void* data) {
+    if (crowd_agent_hook_count == CROWD_AGENT_HOOKS) log_fatal("Trop de fonctions appelées après chaque agent");
+    crowd_agent_hooks[crowd_agent_hook_count] = hook;
+    crowd_agent_hooks_data[crowd_agent_hook_count] = data;
+    crowd_agent_hook_count++;
+}
+
+// Retirer une fonction appelée après chaque agent, enregistrée avec ces données
+void crowd_remove_agent_hook(agent_hook_t hook, void* data) {
+    for (int k = 0; k < crowd_agent_hook_count; k++) {
+        if (crowd_agent_hooks[k] != hook || crowd_agent_hooks_data[k] != data) continue;
+        for (int l = k + 1; l < crowd_agent_hook_count; l++) {
+            crowd_agent_hooks[l - 1] = crowd_agent_hooks[l];
+            crowd_agent_hooks_data[l - 1] = crowd_agent_hooks_data[l];
         }
+        crowd_agent_hook_count--;
+        return;
     }
-    log_debug("Image colorée modifiée en fonction de l'environnement : %s", image.name);
 }
 
-// Distance norme 1
-int distance_norme1(position_t p1, position_t p2) {
-    return abs(p1.i - p2.i) + abs(p1.j - p2.j);
+// Retirer toutes les fonctions appelées après chaque agent
+void crowd_clear_agent_hooks() {
+    crowd_agent_hook_count = 0;
 }
 
 // Parcourir un environnement avec un A* itératif
 void move_env_iterative_a_star(movement_t movement, environment_t* env, int weight0, int alpha, int modulo) {
-    log_debug("Déplacement de %d agents dans un environnement avec A* itératif", movement.agents);
+    move_env_iterative_a_star_from(movement, env, weight0, alpha, modulo, 0);
+}
+
+// Noyau du A* itératif, spécialisé à la compilation sur la connexité, le coût (linéaire ou lu dans une
+// table), les chemins quelconques, l'heuristique (table ou nulle) et la file : la boucle interne ne teste
+// plus ces réglages
+template <int connectivity, bool lookup, bool any_angle, bool heuristic, typename search_queue_t>
+void crowd_route(movement_t movement, environment_t* env, int weight0, int alpha, int modulo, int iteration,
+                 bool shared) {
     position_t start = movement.start;
     position_t target = movement.target;
-    int agents = movement.agents;
-
-    // Initialiser les tableaux
-    for (int i = 0; i < env->rows; i++) {
-        for (int j = 0; j < env->cols; j++) {
-            visited[i][j] = -1;
-        }
-    }
-
-    // Créer une file de priorité
-    priority_queue_t* pq = pq_create(env->rows * env->cols);
+    position_t start_span = movement.start_span;
+    position_t target_span = movement.target_span;
+    int agents = movement.agents - iteration;
+    routing_state.movement = movement;
+    routing_state.weight0 = weight0;
+    routing_state.alpha = alpha;
+    routing_state.modulo = modulo;
+
+    // Créer une file de priorité (agrandie au besoin)
+    search_queue_t* pq;
+    crowd_queue_create(&pq);
+    cost_table_t costs = cost_table_create(weight0, alpha);
+    path_cache_t cache = path_cache_create();
 
     // Boucle principale
-    position_t* s;
-    position_t* t;
-    int iteration = 0;
     while (agents > 0) {
-        if (iteration % modulo != 0) {
-            dis[start.i][start.j] = 0.;
-            visited[start.i][start.j] = iteration;
-            s = ptrs[start.i][start.j];
-            t = ptrs[target.i][target.j];
+        INSTR_TIMER_START(iteration_start);
+        int epoch = crowd_next_epoch(env);
+        routing_state.path_length = 0;
+        if (lookup) cost_table_reserve(&costs, env->max);
+        // Les zones sont reliées à une source virtuelle : toutes leurs cases partent à distance nulle
+        position_t goal, goal_span;
+        bool refresh = iteration % modulo == 0;
+        // Un recalcul pour le dernier agent peut s'arrêter au départ, sauf si le champ sert à d'autres mouvements
+        bool stop_at_goal = !refresh || (agents == 1 && !shared);
+        bool cached = false;
+        if (!refresh) {
+            goal = target;
+            goal_span = target_span;
+            // Le chemin de l'agent précédent est repris sans recherche s'il reste le plus court
+            cached = !any_angle && PATH_CACHE && path_cache_check(&cache, env, &costs, movement);
+            if (!cached) crowd_push_region(pq, env, start, start_span, epoch);
         }
         else {
-            dis[target.i][target.j] = 0.;
-            visited[target.i][target.j] = iteration;
-            s = ptrs[target.i][target.j];
-            t = ptrs[start.i][start.j];
+            goal = start;
+            goal_span = start_span;
+            // Le champ est construit directement par balayages, sans recherche inverse
+            if (HEURISTIC_BUILDER == HEURISTIC_BUILDER_SWEEP) {
+                cost_table_reserve(&costs, env->max);
+                heuristic_sweep(env, &costs, target, target_span, heuristique);
+            }
+            else crowd_push_region(pq, env, target, target_span, epoch);
         }
-        pq_push(pq, 0, (void*) s);
-
-        while (!pq_is_empty(pq)) {
-            position_t* u = (position_t*) pq_pop(pq);
-            if ((iteration % modulo != 0 || agents == 1) && u->i == t->i && u->j == t->j) break;
+        position_t reached = target;
+
+        while (!crowd_queue_is_empty(pq)) {
+            position_t* u = (position_t*) crowd_queue_pop(pq);
+            INSTR_COUNT(INSTR_COUNTER_EXPANDED, 1);
+            if (stop_at_goal && region_contains(goal, goal_span, u->i, u->j)) {
+                reached = *u;
+                break;
+            }
 
-            for (int d = 0; d < 4; d++) {
+            for (int d = 0; d < connectivity; d++) {
                 int ni = u->i + directions[d][0];
                 int nj = u->j + directions[d][1];
 
-                if (ni >= 0 && ni < env->rows && nj >= 0 && nj < env->cols
-                        && visited[ni][nj] < iteration && env->agents[ni][nj] != -1) {
-                    
-                    double dis_n = (visited[ni][nj] == iteration) ? dis[ni][nj] : INFINITY;
-                    double new_dist = dis[u->i][u->j] + (env->agents[ni][nj]*alpha + weight0);
-
-                    if (new_dist < dis_n) {
-                        dis[ni][nj] = new_dist;
-                        pred[ni][nj] = *u;
+                // Une case n'est découverte qu'une fois par recherche : sa distance est encore infinie
+                if (env_can_move(env, u->i, u->j, d) && visited[ni][nj] < epoch) {
+                    double new_dist = dis[u->i][u->j]
+                        + crowd_cost<lookup>(&costs, env->agents[ni][nj], weight0, alpha) * direction_lengths[d];
+                    position_t parent = *u;
+
+                    // Theta* : on passe directement par le prédécesseur de u s'il est en vue (les sources
+                    // sont leur propre prédécesseur)
+                    if (any_angle) {
+                        position_t p = pred[u->i][u->j];
+                        double segment;
+                        if ((p.i != u->i || p.j != u->j)
+                                && crowd_line_of_sight_cost<lookup>(env, p, (position_t) {.i = ni, .j = nj},
+                                                                    &costs, weight0, alpha, &segment)
+                                && dis[p.i][p.j] + segment < new_dist) {
+                            new_dist = dis[p.i][p.j] + segment;
+                            parent = p;
+                        }
+                    }
 
-                        position_t* pos = ptrs[ni][nj];
-                        
-                        visited[ni][nj] = iteration;
+                    dis[ni][nj] = new_dist;
+                    pred[ni][nj] = parent;
+                    visited[ni][nj] = epoch;
 
-                        int total_cost = new_dist + heuristique[ni][nj];
+                    double total_cost = heuristic ? new_dist + heuristique[ni][nj] : new_dist;
 
-                        pq_push(pq, total_cost, (void*) pos);
-                    }
+                    crowd_queue_push(pq, total_cost, (void*) ptrs[ni][nj]);
                 }
             }
-            visited[u->i][u->j] = iteration;
-        }
-        while (!pq_is_empty(pq)) {
-            s = (position_t*) pq_pop(pq);
+            visited[u->i][u->j] = epoch;
         }
+        crowd_queue_clear(pq);
         // Agir sur l'environnement
 
-        if (iteration % modulo == 0) {
-            double** temps = heuristique;
-            heuristique = dis;
-            dis = temps;
+        if (refresh) {
+            if (HEURISTIC_BUILDER != HEURISTIC_BUILDER_SWEEP) {
+                double** temps = heuristique;
+                heuristique = dis;
+                dis = temps;
+            }
+            INSTR_COUNT(INSTR_COUNTER_HEURISTIC_REFRESHES, 1);
+            INSTR_TIMER_STOP(iteration_start, INSTR_STAGE_HEURISTIC_REFRESH);
+        }
+        else if (cached) {
+            INSTR_COUNT(INSTR_COUNTER_PATHS, 1);
+            INSTR_COUNT(INSTR_COUNTER_PATH_CACHE_HITS, 1);
+            for (int k = 0; k < cache.length; k++) {
+                position_t cell = cache.cells[k];
+                env->agents[cell.i][cell.j]++;
+                crowd_path_add(cell);
+                if (k < cache.length - 1) {
+                    INSTR_COUNT(INSTR_COUNTER_PATH_CELLS, 1);
+                    heuristique[cell.i][cell.j] = cache.suffix[k];
+                }
+                if (env->agents[cell.i][cell.j] > env->max) {
+                    env->max = env->agents[cell.i][cell.j];
+                }
+            }
         }
         else {
-            position_t current = target;
-            while ((current.i != start.i || current.j != start.j)
-                    && visited[current.i][current.j] == iteration) {
-                env->agents[current.i][current.j]++;
-                heuristique[current.i][current.j] = dis[target.i][target.j]-dis[current.i][current.j];
-                if (env->agents[current.i][current.j] > env->max) {
-                    env->max = env->agents[current.i][current.j];
+            INSTR_COUNT(INSTR_COUNTER_PATHS, 1);
+            // Le chemin remonte de la case d'arrivée atteinte jusqu'à la première case de la zone de départ
+            // (en chemins quelconques, les cases du segment entre deux sommets sont parcourues)
+            position_t current = reached;
+            while (!region_contains(start, start_span, current.i, current.j)
+                    && visited[current.i][current.j] == epoch) {
+                position_t previous = pred[current.i][current.j];
+                segment_t segment = segment_start(previous, current);
+                for (int k = 1; k <= segment.length; k++) {
+                    segment_next(&segment);
+                    position_t cell = segment.at;
+                    env->agents[cell.i][cell.j]++;
+                    crowd_path_add(cell);
+                    INSTR_COUNT(INSTR_COUNTER_PATH_CELLS, 1);
+                    // Distance interpolée le long du segment
+                    double dis_cell = (k == segment.length) ? dis[current.i][current.j]
+                        : dis[previous.i][previous.j]
+                          + (dis[current.i][current.j] - dis[previous.i][previous.j]) * k / segment.length;
+                    heuristique[cell.i][cell.j] = dis[reached.i][reached.j]-dis_cell;
+                    if (env->agents[cell.i][cell.j] > env->max) {
+                        env->max = env->agents[cell.i][cell.j];
+                    }
+                }
+                // Le segment est parcouru vers l'arrivée : ses cases sont remises dans l'ordre du chemin
+                for (int a = routing_state.path_length - segment.length, b = routing_state.path_length - 1;
+                        a < b; a++, b--) {
+                    position_t swap = crowd_path[a];
+                    crowd_path[a] = crowd_path[b];
+                    crowd_path[b] = swap;
                 }
-                current = pred[current.i][current.j];
+                current = previous;
             }
-            env->agents[start.i][start.j]++;
-            if (env->agents[start.i][start.j] > env->max) {
-                env->max = env->agents[start.i][start.j];
+            if (!region_contains(start, start_span, current.i, current.j)) current = start;
+            env->agents[current.i][current.j]++;
+            crowd_path_add(current);
+            if (env->agents[current.i][current.j] > env->max) {
+                env->max = env->agents[current.i][current.j];
             }
+            if (!any_angle && PATH_CACHE) path_cache_store(&cache, crowd_path, routing_state.path_length, movement);
         }
         
         iteration++;
         agents--;
+
+        routing_state.iteration = iteration;
+        for (int h = 0; h < crowd_agent_hook_count; h++) {
+            crowd_agent_hooks[h](&routing_state, env, crowd_agent_hooks_data[h]);
+        }
     }
     log_debug("Tous les agents ont été déplacés");
+    if (PATH_CACHE) log_debug("Cache de chemins : %d agents sans recherche, %d chemins rejetés", cache.hits, cache.misses);
     // Libérer les ressources
-    pq_free(pq);
+    crowd_queue_free(pq);
+    cost_table_free(&costs);
+    path_cache_free(&cache);
+}
+
+// Noyau du A* itératif
+typedef void (*crowd_kernel_t)(movement_t movement, environment_t* env, int weight0, int alpha, int modulo,
+                               int iteration, bool shared);
 
+// Choix du noyau, un réglage après l'autre
+template <int connectivity, bool lookup, bool any_angle, bool heuristic>
+crowd_kernel_t crowd_kernel_queue() {
+    if (SEARCH_QUEUE == SEARCH_QUEUE_BUCKETS) return crowd_route<connectivity, lookup, any_angle, heuristic, bucket_queue_t>;
+    return crowd_route<connectivity, lookup, any_angle, heuristic, priority_queue_t>;
+}
+
+template <int connectivity, bool lookup, bool any_angle>
+crowd_kernel_t crowd_kernel_heuristic() {
+    if (SEARCH_HEURISTIC) return crowd_kernel_queue<connectivity, lookup, any_angle, true>();
+    return crowd_kernel_queue<connectivity, lookup, any_angle, false>();
+}
+
+template <int connectivity, bool lookup>
+crowd_kernel_t crowd_kernel_any_angle() {
+    if (ANY_ANGLE) return crowd_kernel_heuristic<connectivity, lookup, true>();
+    return crowd_kernel_heuristic<connectivity, lookup, false>();
+}
+
+template <int connectivity>
+crowd_kernel_t crowd_kernel_cost() {
+    if (COST_MODEL != COST_MODEL_LINEAR) return crowd_kernel_any_angle<connectivity, true>();
+    return crowd_kernel_any_angle<connectivity, false>();
+}
+
+// Noyau correspondant à la configuration
+crowd_kernel_t crowd_kernel() {
+    if (CONNECTIVITY == 8) return crowd_kernel_cost<8>();
+    return crowd_kernel_cost<4>();
+}
+
+// Reprendre le parcours d'un mouvement après ses iteration premiers agents
+void move_env_iterative_a_star_from(movement_t movement, environment_t* env, int weight0, int alpha, int modulo,
+                                    int iteration) {
+    log_debug("Déplacement de %d agents dans un environnement avec A* itératif", movement.agents - iteration);
+    INSTR_SCOPE(INSTR_STAGE_MOVEMENT);
+    crowd_kernel()(movement, env, weight0, alpha, modulo, iteration, false);
+    log_debug("Déplacement des %d agents dans un environnement avec A* itératif terminé", movement.agents);
+}
+
+// Reprendre le parcours d'un mouvement dont l'heuristique sert aussi à d'autres mouvements
+void move_env_iterative_a_star_shared(movement_t movement, environment_t* env, int weight0, int alpha, int modulo,
+                                      int iteration) {
+    log_debug("Déplacement de %d agents dans un environnement avec A* itératif (heuristique partagée)",
+              movement.agents - iteration);
+    INSTR_SCOPE(INSTR_STAGE_MOVEMENT);
+    crowd_kernel()(movement, env, weight0, alpha, modulo, iteration, true);
     log_debug("Déplacement des %d agents dans un environnement avec A* itératif terminé", movement.agents);
 }
 
 // Appliquer plusieurs mouvements à un environnement avec A* itératif
-void multiple_move_env_iterative_a_star(circular_list_t* movements, environment_t* env,
+void multiple_move_env_iterative_a_star(movement_list_t* movements, environment_t* env,
                                         int weight0, int alpha, int modulo) {
+    multiple_move_env_iterative_a_star_from(movements, env, weight0, alpha, modulo, 0);
+}
+
+// Reprendre plusieurs mouvements, le premier après ses iteration premiers agents
+void multiple_move_env_iterative_a_star_from(movement_list_t* movements, environment_t* env,
+                                             int weight0, int alpha, int modulo, int iteration) {
     log_debug("Déplacement d'agents dans un environnement avec A* itératif");
-    int n = movements->size;
-    while (!cl_is_empty(movements)) {
-        movement_t* m = (movement_t*) cl_get(movements);
-        move_env_iterative_a_star(*m, env, weight0, alpha, modulo);
-        free(m);
-        cl_remove(movements);
+    INSTR_SCOPE(INSTR_STAGE_ROUTING);
+    int n = ml_remaining(movements);
+    routing_state.movements = movements;
+    while (!ml_is_empty(movements)) {
+        movement_t* m = ml_get(movements);
+        move_env_iterative_a_star_from(*m, env, weight0, alpha, modulo, iteration);
+        iteration = 0;
+        ml_remove(movements);
     }
+    routing_state.movements = NULL;
     log_debug("Déplacement d'agents dans un environnement avec A* itératif terminé");
 }
 
@@ -227,6 +522,8 @@ void env_initialiser_tableaux(environment_t* env) {
     heuristique_in_queue = (int**) malloc(sizeof(int*) * env->rows);
     visited = (int**) malloc(sizeof(int*) * env->rows);
     ptrs = (position_t***) malloc(sizeof(position_t**) * env->rows);
+    // Les positions pointées sont dans un seul bloc, ligne après ligne
+    position_t* cells = (position_t*) malloc(sizeof(position_t) * env->rows * env->cols);
     for (int i = 0; i < env->rows; i++) {
         pred[i] = (position_t*) malloc(sizeof(position_t) * env->cols);
         heuristique[i] = (double*) malloc(sizeof(double) * env->cols);
@@ -242,15 +539,30 @@ void env_initialiser_tableaux(environment_t* env) {
             heuristique_propagation[i][j] = 0;
             heuristique_in_queue[i][j] = false;
             visited[i][j] = -1;
-            ptrs[i][j] = (position_t*) malloc(sizeof(position_t));
+            ptrs[i][j] = &cells[i * env->cols + j];
             ptrs[i][j]->i = i;
             ptrs[i][j]->j = j;
         }
     }
 }
 
+// Remettre les tableaux à leur état initial pour un nouvel environnement de même taille
+void env_reinitialiser_tableaux(environment_t* env) {
+    for (int i = 0; i < env->rows; i++) {
+        for (int j = 0; j < env->cols; j++) {
+            pred[i][j] = (position_t) {.i = -1, .j = -1};
+            dis[i][j] = 0;
+            heuristique[i][j] = 0;
+            heuristique_propagation[i][j] = 0;
+            heuristique_in_queue[i][j] = false;
+            visited[i][j] = -1;
+        }
+    }
+}
+
 // Libérer les ressources allouées pour les tableaux
 void env_liberer_tableaux(environment_t* env) {
+    if (env->rows > 0) free(ptrs[0][0]);
     for (int i = 0; i < env->rows; i++) {
         free(pred[i]);
         free(dis[i]);
@@ -258,9 +570,6 @@ void env_liberer_tableaux(environment_t* env) {
         free(heuristique_propagation[i]);
         free(heuristique_in_queue[i]);
         free(visited[i]);
-        for (int j = 0; j < env->cols; j++) {
-            free(ptrs[i][j]);
-        }
         free(ptrs[i]);
     }
     free(ptrs);
@@ -4,7 +4,7 @@
 
 #include "image.h"
 #include "image_usage.h"
-#include "circular_list.h"
+#include "movement_list.h"
 #include "common.h"
 
 struct environment_s {
@@ -15,28 +15,115 @@ struct environment_s {
 };
 typedef struct environment_s environment_t;
 
+// Files de la recherche
+enum search_queue_e {
+    SEARCH_QUEUE_HEAP,      // Tas binaire (par défaut)
+    SEARCH_QUEUE_BUCKETS,   // Un seau par priorité entière (modèle linéaire, connexité 4, sans ANY_ANGLE)
+};
+
+// File de priorité du A* itératif
+extern int SEARCH_QUEUE;
+
+// Heuristique du A* itératif : 1 pour la table recalculée tous les modulo agents, 0 pour aucune (Dijkstra)
+extern int SEARCH_HEURISTIC;
+
+// Tester si un déplacement dans la direction d depuis (i, j) mène à une case libre de l'environnement,
+// sans couper le coin d'un mur en diagonale
+static inline bool env_can_move(environment_t* env, int i, int j, int d) {
+    int ni = i + directions[d][0];
+    int nj = j + directions[d][1];
+    if (ni < 0 || ni >= env->rows || nj < 0 || nj >= env->cols || env->agents[ni][nj] == -1) return false;
+    return d < 4 || (env->agents[ni][j] != -1 && env->agents[i][nj] != -1);
+}
+
+// Tracé de Bresenham d'un segment, case par case
+struct segment_s {
+    position_t at;      // Case courante
+    int di;
+    int dj;
+    int si;
+    int sj;
+    int error;
+    int length;         // Nombre de pas jusqu'à l'extrémité
+};
+typedef struct segment_s segment_t;
+
+// Commencer le tracé de Bresenham du segment de a vers b
+segment_t segment_start(position_t a, position_t b);
+
+// Avancer d'une case sur un segment
+void segment_next(segment_t* segment);
+
+// Vue directe de a vers b : le segment ne traverse ni mur ni coin de mur. cost reçoit la somme des coûts
+// des cases traversées (a exclue), ramenée à la longueur euclidienne du segment
+bool crowd_line_of_sight(environment_t* env, position_t a, position_t b, int weight0, int alpha, double* cost);
+
+// Allouer un environnement vide ; les cases sont contiguës (ligne après ligne) à partir de agents[0]
+environment_t env_alloc(int rows, int cols);
+
+// Etat d'un routage itératif en cours
+struct routing_state_s {
+    movement_list_t* movements;  // Mouvements restants, celui en cours en premier
+    movement_t movement;         // Mouvement en cours
+    int iteration;               // Agents du mouvement en cours déjà routés
+    int weight0;
+    int alpha;
+    int modulo;
+    const position_t* path;      // Cases du dernier agent, de l'arrivée au départ (vide après un recalcul)
+    int path_length;
+};
+typedef struct routing_state_s routing_state_t;
+
+// Fonction appelée après chaque agent routé par le A* itératif
+typedef void (*agent_hook_t)(const routing_state_t* state, environment_t* env, void* data);
+
 // Créer un environnement à partir d'une image
 environment_t env_from_image(image_t image);
 
 // Libérer la mémoire occupée par un environnement
 void env_free(environment_t env);
 
-// Modifier une image en fonction de l'environnement
-void env_image_edit(image_t image, environment_t env, int n);
+// Copier un environnement
+environment_t env_copy(environment_t env);
+
+// Recopier l'état d'un environnement dans un autre de même taille (une seule copie mémoire)
+void env_copy_into(environment_t* copy, environment_t env);
+
+// Ajouter une fonction appelée après chaque agent routé par le A* itératif
+void crowd_add_agent_hook(agent_hook_t hook, void* data);
 
-// Modifier une image colorée en fonction de l'environnement
-void env_image_colored_edit(colored_image_t image, environment_t env, int n);
+// Retirer une fonction appelée après chaque agent, enregistrée avec ces données (sans effet si absente)
+void crowd_remove_agent_hook(agent_hook_t hook, void* data);
+
+// Retirer toutes les fonctions appelées après chaque agent
+void crowd_clear_agent_hooks();
 
 // Parcourir un environnement avec un A* itératif
 void move_env_iterative_a_star(movement_t movement, environment_t* env, int weight0, int alpha, int n);
 
+// Reprendre le parcours d'un mouvement après ses iteration premiers agents
+void move_env_iterative_a_star_from(movement_t movement, environment_t* env, int weight0, int alpha, int modulo,
+                                    int iteration);
+
+// Reprendre le parcours d'un mouvement dont l'heuristique sert aussi aux mouvements suivants (même cible) :
+// chaque recalcul construit le champ complet, même pour le dernier agent du mouvement
+void move_env_iterative_a_star_shared(movement_t movement, environment_t* env, int weight0, int alpha, int modulo,
+                                      int iteration);
+
 // Appliquer plusieurs mouvements à un environnement avec A* itératif
-void multiple_move_env_iterative_a_star(circular_list_t* movements, environment_t* env,
+void multiple_move_env_iterative_a_star(movement_list_t* movements, environment_t* env,
                                         int weight0, int alpha, int modulo);
 
+// Reprendre plusieurs mouvements, le premier après ses iteration premiers agents
+void multiple_move_env_iterative_a_star_from(movement_list_t* movements, environment_t* env,
+                                             int weight0, int alpha, int modulo, int iteration);
+
 // Initialiser les tableaux nécessaires pour les déplacements dans un environnement
 void env_initialiser_tableaux(environment_t* env);
 
+// Remettre les tableaux à leur état initial pour un nouvel environnement de même taille
+void env_reinitialiser_tableaux(environment_t* env);
+
 // Libérer les ressources allouées pour les tableaux
 void env_liberer_tableaux(environment_t* env);
 
@@ -1,59 +1,305 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "csv.h"
 #include "common.h"
-#include "circular_list.h"
+#include "movement_list.h"
+#include "parallel.h"
+#include "logging.h"
+#include "instrument.h"
 
-circular_list_t* load_movements(const char* filename, int n) {
-    FILE* file = fopen(filename, "r");
-    if (!file) return NULL;
+#define MOVEMENTS_BINARY_MAGIC "CCMOVES3"
+#define MOVEMENTS_BINARY_FIELDS 10
+#define MOVEMENTS_PARALLEL_MIN_BYTES (1 << 20)
+#define MOVEMENTS_MAX_REPORTED 10
 
-    char line[4096];
-    // Sauter l'en-tête
-    if (!fgets(line, sizeof(line), file)) {
-        fclose(file);
+// Morceau de fichier lu par un fil d'exécution
+struct movements_chunk_s {
+    const char* start;
+    const char* end;
+    int lines;                // Lignes du morceau
+    int first_line;           // Numéro (dans le fichier) de sa première ligne
+    movement_t* output;       // Emplacement de ses mouvements dans le tableau final
+    int valid;
+    int malformed;
+    int reported[MOVEMENTS_MAX_REPORTED];
+};
+typedef struct movements_chunk_s movements_chunk_t;
+
+// Morceaux d'un fichier et facteur de réduction
+struct movements_parse_s {
+    movements_chunk_t* chunks;
+    int n;
+};
+typedef struct movements_parse_s movements_parse_t;
+
+// Ignorer les espaces
+const char* movements_skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+// Lire un entier signé ; renvoie NULL si aucun chiffre n'est lu
+const char* movements_parse_int(const char* p, const char* end, int* value) {
+    p = movements_skip_blanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    if (p == end || *p < '0' || *p > '9') return NULL;
+    long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+        if (v > 2147483647L) return NULL;
+    }
+    *value = (int) (negative ? -v : v);
+    return p;
+}
+
+// Lire une position y:x ou une zone y0:x0-y1:x1 (coins opposés, dans n'importe quel ordre) ;
+// renvoie NULL si elle est mal formée
+const char* movements_parse_region(const char* p, const char* end, position_t* corner, position_t* span) {
+    int values[4];
+    int count = 2;
+    for (int k = 0; k < count; k++) {
+        p = movements_parse_int(p, end, &values[k]);
+        if (p == NULL) return NULL;
+        p = movements_skip_blanks(p, end);
+        if (k % 2 == 0) {
+            if (p == end || *p != ':') return NULL;
+            p++;
+        }
+        else if (k == 1 && p < end && *p == '-') {
+            count = 4;
+            p++;
+        }
+    }
+    if (count == 2) {
+        values[2] = values[0];
+        values[3] = values[1];
+    }
+    *corner = (position_t) {.i = (values[0] < values[2]) ? values[0] : values[2],
+                            .j = (values[1] < values[3]) ? values[1] : values[3]};
+    *span = (position_t) {.i = abs(values[2] - values[0]), .j = abs(values[3] - values[1])};
+    return p;
+}
+
+// Lire une ligne départ,arrivée,n[,instant de départ] ; renvoie false si elle est mal formée
+bool movements_parse_line(const char* p, const char* end, movement_t* m) {
+    movement_t read = {};
+    p = movements_parse_region(p, end, &read.start, &read.start_span);
+    if (p == NULL || p == end || *p != ',') return false;
+    p = movements_parse_region(p + 1, end, &read.target, &read.target_span);
+    if (p == NULL || p == end || *p != ',') return false;
+    p = movements_parse_int(p + 1, end, &read.agents);
+    if (p == NULL) return false;
+    p = movements_skip_blanks(p, end);
+    if (p < end && *p == ',') {
+        p = movements_parse_int(p + 1, end, &read.departure);
+        if (p == NULL || read.departure < 0) return false;
+    }
+    if (movements_skip_blanks(p, end) != end) return false;
+    *m = read;
+    return true;
+}
+
+// Réduire une zone d'un facteur n (les deux coins sont divisés)
+void movements_compress_region(position_t* corner, position_t* span, int n) {
+    position_t last = {.i = corner->i + span->i, .j = corner->j + span->j};
+    *corner = (position_t) {.i = corner->i / n, .j = corner->j / n};
+    *span = (position_t) {.i = last.i / n - corner->i, .j = last.j / n - corner->j};
+}
+
+// Réduire un mouvement d'un facteur n
+void movements_compress(movement_t* m, int n) {
+    movements_compress_region(&m->start, &m->start_span, n);
+    movements_compress_region(&m->target, &m->target_span, n);
+}
+
+// Compter les lignes des morceaux [start, end)
+void movements_count_chunks(int start, int end, void* data) {
+    movements_parse_t* parse = (movements_parse_t*) data;
+    for (int c = start; c < end; c++) {
+        movements_chunk_t* chunk = &parse->chunks[c];
+        chunk->lines = 0;
+        for (const char* p = chunk->start; p < chunk->end; p++) {
+            if (*p == '\n') chunk->lines++;
+        }
+        if (chunk->end > chunk->start && chunk->end[-1] != '\n') chunk->lines++;
+    }
+}
+
+// Lire les mouvements des morceaux [start, end)
+void movements_parse_chunks(int start, int end, void* data) {
+    movements_parse_t* parse = (movements_parse_t*) data;
+    for (int c = start; c < end; c++) {
+        movements_chunk_t* chunk = &parse->chunks[c];
+        chunk->valid = 0;
+        chunk->malformed = 0;
+        int line = chunk->first_line;
+        const char* p = chunk->start;
+        while (p < chunk->end) {
+            const char* eol = (const char*) memchr(p, '\n', chunk->end - p);
+            if (eol == NULL) eol = chunk->end;
+            movement_t m;
+            if (movements_parse_line(p, eol, &m)) {
+                movements_compress(&m, parse->n);
+                chunk->output[chunk->valid++] = m;
+            }
+            else if (movements_skip_blanks(p, eol) != eol) {
+                // Les lignes vides sont ignorées, les autres sont signalées
+                if (chunk->malformed < MOVEMENTS_MAX_REPORTED) chunk->reported[chunk->malformed] = line;
+                chunk->malformed++;
+            }
+            p = eol + 1;
+            line++;
+        }
+    }
+}
+
+// Lire des mouvements au format binaire : fields entiers par mouvement (5 en version 1, 9 en version 2
+// avec les zones, 10 en version 3 avec l'instant de départ)
+movement_list_t* load_movements_binary(const char* data, long long size, int n, int fields, const char* filename) {
+    int count;
+    if (size < 8 + (long long) sizeof(int)) return NULL;
+    memcpy(&count, data + 8, sizeof(int));
+    if (count < 0 || size != 8 + (long long) sizeof(int) + (long long) count * fields * (long long) sizeof(int)) {
+        log_error("Fichier de mouvements binaire tronqué : %s", filename);
         return NULL;
     }
+    movement_list_t* movements = ml_create(count);
+    const char* p = data + 8 + sizeof(int);
+    for (int k = 0; k < count; k++, p += fields * sizeof(int)) {
+        int values[MOVEMENTS_BINARY_FIELDS] = {0};
+        memcpy(values, p, fields * sizeof(int));
+        movement_t m = {
+            .start = {.i = values[0], .j = values[1]},
+            .target = {.i = values[2], .j = values[3]},
+            .agents = values[4],
+            .start_span = {.i = values[5], .j = values[6]},
+            .target_span = {.i = values[7], .j = values[8]},
+            .departure = values[9]
+        };
+        movements_compress(&m, n);
+        ml_add(movements, m);
+    }
+    return movements;
+}
 
-    circular_list_t* cl = cl_create();
+// Lire des mouvements au format CSV, par morceaux en parallèle pour les grands fichiers
+movement_list_t* load_movements_text(const char* data, long long size, int n, const char* filename) {
+    const char* end = data + size;
+    // Sauter l'en-tête
+    const char* body = (const char*) memchr(data, '\n', size);
+    if (body == NULL) return ml_create(1);
+    body++;
 
-    while (fgets(line, sizeof(line), file)) {
-        position_t start, target;
-        int agents;
+    // Morceaux coupés en fin de ligne
+    int count = (end - body >= MOVEMENTS_PARALLEL_MIN_BYTES) ? parallel_threads() : 1;
+    movements_chunk_t* chunks = (movements_chunk_t*) calloc(count, sizeof(movements_chunk_t));
+    const char* p = body;
+    for (int c = 0; c < count; c++) {
+        chunks[c].start = p;
+        const char* cut = (c == count - 1) ? end : body + (end - body) * (c + 1) / count;
+        if (cut < p) cut = p;
+        const char* eol = (const char*) memchr(cut, '\n', end - cut);
+        chunks[c].end = (c == count - 1 || eol == NULL) ? end : eol + 1;
+        p = chunks[c].end;
+    }
+    movements_parse_t parse = {.chunks = chunks, .n = n};
+    parallel_for(count, movements_count_chunks, &parse);
 
-        if (sscanf(line, "%d:%d,%d:%d,%d", &start.i, &start.j, &target.i, &target.j, &agents) == 5) {
-            start.i /= n;
-            start.j /= n;
-            target.i /= n;
-            target.j /= n;
-            
-            movement_t* m = (movement_t*) malloc(sizeof(movement_t));
-            m->start = start;
-            m->target = target;
-            m->agents = agents;
-            cl_add(cl, (void*) m);
+    // Chaque morceau écrit à sa place dans le tableau final
+    int lines = 0;
+    for (int c = 0; c < count; c++) {
+        chunks[c].first_line = lines + 2;
+        lines += chunks[c].lines;
+    }
+    movement_list_t* movements = ml_create(lines);
+    for (int c = 0, offset = 0; c < count; offset += chunks[c].lines, c++) {
+        chunks[c].output = movements->items + offset;
+    }
+    parallel_for(count, movements_parse_chunks, &parse);
+
+    // Rassembler les mouvements valides et signaler les lignes mal formées
+    int malformed = 0;
+    for (int c = 0; c < count; c++) {
+        memmove(movements->items + movements->size, chunks[c].output, sizeof(movement_t) * chunks[c].valid);
+        movements->size += chunks[c].valid;
+        for (int k = 0; k < chunks[c].malformed && k < MOVEMENTS_MAX_REPORTED; k++) {
+            if (malformed++ < MOVEMENTS_MAX_REPORTED) {
+                log_warning("Ligne %d mal formée dans %s", chunks[c].reported[k], filename);
+            }
         }
+        if (chunks[c].malformed > MOVEMENTS_MAX_REPORTED) malformed += chunks[c].malformed - MOVEMENTS_MAX_REPORTED;
     }
+    if (malformed > 0) log_warning("%d lignes mal formées ignorées dans %s", malformed, filename);
+    free(chunks);
+    return movements;
+}
 
-    fclose(file);
-    return cl;
+// Charge les mouvements depuis un fichier CSV ou binaire (traités de la dernière ligne à la première)
+movement_list_t* load_movements(const char* filename, int n) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    const char* data = (const char*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    movement_list_t* movements;
+    // Les versions précédentes du format binaire ont moins de champs par mouvement
+    const int fields[3] = {5, 9, MOVEMENTS_BINARY_FIELDS};
+    int version = 0;
+    if (st.st_size >= 8 && memcmp(data, MOVEMENTS_BINARY_MAGIC, 7) == 0) version = data[7] - '0';
+    if (version >= 1 && version <= 3) {
+        movements = load_movements_binary(data, st.st_size, n, fields[version - 1], filename);
+    }
+    else {
+        movements = load_movements_text(data, st.st_size, n, filename);
+    }
+    munmap((void*) data, st.st_size);
+    if (movements == NULL) return NULL;
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, sizeof(movement_t) * movements->size);
+
+    // Les mouvements ont toujours été traités de la dernière ligne à la première
+    ml_reverse(movements);
+    return movements;
 }
 
-void free_movements(circular_list_t* cl) {
-    if (cl_is_empty(cl)) {
-        cl_free(cl);
-        return;
+// Ecrire des mouvements au format binaire (dans l'ordre du fichier)
+bool save_movements_binary(movement_list_t* movements, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return false;
+    int count = ml_remaining(movements);
+    fwrite(MOVEMENTS_BINARY_MAGIC, 1, 8, file);
+    fwrite(&count, sizeof(int), 1, file);
+    // La liste est dans l'ordre de traitement, l'inverse de celui du fichier
+    for (int k = movements->size - 1; k >= movements->first; k--) {
+        movement_t* m = &movements->items[k];
+        int values[MOVEMENTS_BINARY_FIELDS] = {m->start.i, m->start.j, m->target.i, m->target.j, m->agents,
+                                               m->start_span.i, m->start_span.j,
+                                               m->target_span.i, m->target_span.j, m->departure};
+        fwrite(values, sizeof(int), MOVEMENTS_BINARY_FIELDS, file);
     }
-    movement_t* m = (movement_t*) cl_get(cl);
-    free(m);
-    cl_remove(cl);
-    free_movements(cl);
+    bool written = !ferror(file);
+    return fclose(file) == 0 && written;
+}
+
+void free_movements(movement_list_t* movements) {
+    ml_free(movements);
 }
 
 // Écrire le résultat en performance d'une exécution de parcours dans un fichier CSV
 void write_result(const char* filename, int modulo, int clocks, double time) {
-    fopen(filename, "a");
     FILE* file = fopen(filename, "a");
     if (!file) return;
     fprintf(file, "%d;%d;%lf\n", modulo, clocks, time);
@@ -1,14 +1,20 @@
 #ifndef CSV_H
 #define CSV_H
 
+#include <stdbool.h>
+
 #include "common.h"
-#include "circular_list.h"
+#include "movement_list.h"
+
+// Charge les mouvements depuis un fichier CSV ou binaire (traités de la dernière ligne à la première)
+// Les lignes mal formées sont signalées et ignorées
+movement_list_t* load_movements(const char* filename, int n);
 
-// Charge les mouvements depuis un fichier CSV et retourne la tête de la liste circulaire
-circular_list_t* load_movements(const char* filename, int n);
+// Ecrire des mouvements au format binaire (dans l'ordre du fichier)
+bool save_movements_binary(movement_list_t* movements, const char* filename);
 
-// Libère la mémoire de la liste circulaire
-void free_movements(circular_list_t* cl);
+// Libère la mémoire de la liste de mouvements
+void free_movements(movement_list_t* movements);
 
 // Écrire le résultat en performance d'une exécution de parcours dans un fichier CSV
 void write_result(const char* filename, int modulo, int clocks, double time);
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "equilibrium.h"
+#include "crowd.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "parallel.h"
+#include "logging.h"
+#include "common.h"
+#include "instrument.h"
+#include "cost.h"
+
+int EQUILIBRIUM_ITERATIONS = 0; // Affectation à l'équilibre désactivée par défaut
+int EQUILIBRIUM_METHOD = 0;
+int EQUILIBRIUM_GAP = 10;
+
+// Pas de la recherche linéaire de Frank-Wolfe (dichotomie)
+#define EQUILIBRIUM_LINE_SEARCH_STEPS 20
+
+// Distance minorant le nombre de pas d'une case à une zone
+double equilibrium_region_distance(int i, int j, position_t corner, position_t span) {
+    int di = (i < corner.i) ? corner.i - i : (i > corner.i + span.i) ? i - corner.i - span.i : 0;
+    int dj = (j < corner.j) ? corner.j - j : (j > corner.j + span.j) ? j - corner.j - span.j : 0;
+    return grid_distance(di, dj);
+}
+
+// Plus court chemin d'un mouvement sur les coûts courants : A* guidé par le plus petit coût d'une case fois
+// la distance à la zone d'arrivée
+void equilibrium_route(equilibrium_t* eq, equilibrium_search_t* search, int m) {
+    environment_t* env = eq->env;
+    movement_t* movement = &eq->movements[m];
+    position_t target = movement->target;
+    position_t target_span = movement->target_span;
+    int epoch = ++search->epoch;
+    priority_queue_t* pq = search->pq;
+    pq_clear(pq);
+
+    region_cells_t cells = region_cells(movement->start, movement->start_span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        int c = p.i * env->cols + p.j;
+        search->dis[c] = 0.;
+        search->pred[c] = -1;
+        search->seen[c] = epoch;
+        double h = eq->table.lower * equilibrium_region_distance(p.i, p.j, target, target_span);
+        pq_push(pq, h, (void*) &eq->ids[c]);
+    }
+
+    int reached = -1;
+    while (!pq_is_empty(pq)) {
+        int c = *(int*) pq_pop(pq);
+        if (search->closed[c] == epoch) continue;
+        search->closed[c] = epoch;
+        INSTR_COUNT(INSTR_COUNTER_EXPANDED, 1);
+        int ci = c / env->cols;
+        int cj = c % env->cols;
+        if (region_contains(target, target_span, ci, cj)) {
+            reached = c;
+            break;
+        }
+
+        for (int d = 0; d < CONNECTIVITY; d++) {
+            if (!env_can_move(env, ci, cj, d)) continue;
+            int ni = ci + directions[d][0];
+            int nj = cj + directions[d][1];
+            int n = ni * env->cols + nj;
+            if (search->closed[n] == epoch) continue;
+            double new_dist = search->dis[c] + eq->costs[n] * direction_lengths[d];
+            if (search->seen[n] != epoch || new_dist < search->dis[n]) {
+                search->seen[n] = epoch;
+                search->dis[n] = new_dist;
+                search->pred[n] = c;
+                double h = eq->table.lower * equilibrium_region_distance(ni, nj, target, target_span);
+                pq_push(pq, new_dist + h, (void*) &eq->ids[n]);
+            }
+        }
+    }
+
+    // Chemin de l'arrivée vers le départ
+    eq->path_lengths[m] = 0;
+    eq->shortest[m] = 0.;
+    if (reached == -1) return;
+    eq->shortest[m] = search->dis[reached];
+    for (int c = reached; c != -1; c = search->pred[c]) {
+        if (eq->path_lengths[m] == eq->path_capacities[m]) {
+            eq->path_capacities[m] = (eq->path_capacities[m] > 0) ? 2 * eq->path_capacities[m] : 256;
+            eq->paths[m] = (int*) realloc(eq->paths[m], sizeof(int) * eq->path_capacities[m]);
+        }
+        eq->paths[m][eq->path_lengths[m]++] = c;
+    }
+}
+
+// Router des mouvements jusqu'à épuisement ; le fil start utilise le jeu de tableaux start
+void equilibrium_worker(int start, int end, void* data) {
+    (void) end;
+    equilibrium_t* eq = (equilibrium_t*) data;
+    int m;
+    while ((m = __atomic_fetch_add(&eq->next, 1, __ATOMIC_RELAXED)) < eq->count) {
+        equilibrium_route(eq, &eq->searches[start], m);
+    }
+}
+
+// Charge tout-ou-rien : les agents de chaque mouvement sur son plus court chemin
+void equilibrium_load(equilibrium_t* eq) {
+    int size = eq->env->rows * eq->env->cols;
+    memset(eq->load, 0, sizeof(double) * size);
+    memset(eq->load_weighted, 0, sizeof(double) * size);
+    int cols = eq->env->cols;
+    for (int m = 0; m < eq->count; m++) {
+        int* path = eq->paths[m];
+        double agents = eq->movements[m].agents;
+        for (int k = 0; k < eq->path_lengths[m]; k++) {
+            int c = path[k];
+            eq->load[c] += agents;
+            if (k + 1 < eq->path_lengths[m]) {
+                bool diagonal = c / cols != path[k + 1] / cols && c % cols != path[k + 1] % cols;
+                eq->load_weighted[c] += agents * direction_lengths[diagonal ? 4 : 0];
+            }
+        }
+    }
+}
+
+// Coût d'une case pour un flux fractionnaire (interpolé entre deux nombres d'agents de la table)
+double equilibrium_cost(equilibrium_t* eq, double agents) {
+    int k = (int) agents;
+    double low = cost_get(&eq->table, k);
+    return low + (agents - k) * (cost_get(&eq->table, k + 1) - low);
+}
+
+// Coûts de toutes les cases pour le flux courant
+void equilibrium_update_costs(equilibrium_t* eq) {
+    int* base = eq->env->agents[0];
+    for (int c = 0; c < eq->env->rows * eq->env->cols; c++) {
+        if (base[c] == -1) continue;
+        eq->costs[c] = equilibrium_cost(eq, base[c] + eq->flow[c]);
+    }
+}
+
+// Pas de Frank-Wolfe : la dérivée de l'objectif le long de la direction (charge - flux) est annulée par
+// dichotomie sur [0, 1]
+double equilibrium_line_search(equilibrium_t* eq, int* active, int count) {
+    int* base = eq->env->agents[0];
+    double low = 0.;
+    double high = 1.;
+    for (int s = 0; s <= EQUILIBRIUM_LINE_SEARCH_STEPS; s++) {
+        double step = (s == 0) ? 1. : (low + high) / 2;
+        double slope = 0.;
+        for (int k = 0; k < count; k++) {
+            int c = active[k];
+            double flow = eq->flow[c] + step * (eq->load[c] - eq->flow[c]);
+            slope += equilibrium_cost(eq, base[c] + flow) * (eq->load_weighted[c] - eq->weighted[c]);
+        }
+        if (s == 0 && slope <= 0.) return 1.;
+        if (slope > 0.) high = step;
+        else low = step;
+    }
+    return (low + high) / 2;
+}
+
+// Appliquer plusieurs mouvements à un environnement par affectation à l'équilibre
+void multiple_move_env_equilibrium(movement_list_t* movements, environment_t* env, int weight0, int alpha) {
+    log_debug("Déplacement d'agents par affectation à l'équilibre");
+    INSTR_SCOPE(INSTR_STAGE_ROUTING);
+    int size = env->rows * env->cols;
+    int count = ml_remaining(movements);
+    int threads = parallel_threads();
+    equilibrium_t eq = {
+        .env = env,
+        .movements = ml_get(movements),
+        .count = count,
+        .table = cost_table_create(weight0, alpha),
+        .flow = (double*) calloc(size, sizeof(double)),
+        .weighted = (double*) calloc(size, sizeof(double)),
+        .load = (double*) malloc(sizeof(double) * size),
+        .load_weighted = (double*) malloc(sizeof(double) * size),
+        .costs = (double*) malloc(sizeof(double) * size),
+        .shortest = (double*) malloc(sizeof(double) * count),
+        .paths = (int**) calloc(count, sizeof(int*)),
+        .path_lengths = (int*) calloc(count, sizeof(int)),
+        .path_capacities = (int*) calloc(count, sizeof(int)),
+        .ids = (int*) malloc(sizeof(int) * size),
+        .searches = (equilibrium_search_t*) malloc(sizeof(equilibrium_search_t) * threads),
+        .next = 0,
+        .routed = 0
+    };
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 12);
+    for (int c = 0; c < size; c++) eq.ids[c] = c;
+    for (int t = 0; t < threads; t++) {
+        eq.searches[t] = (equilibrium_search_t) {
+            .dis = (double*) malloc(sizeof(double) * size),
+            .pred = (int*) malloc(sizeof(int) * size),
+            .seen = (int*) calloc(size, sizeof(int)),
+            .closed = (int*) calloc(size, sizeof(int)),
+            .epoch = 0,
+            .pq = pq_create(1024)
+        };
+    }
+    int* active = (int*) malloc(sizeof(int) * size);
+    double target_gap = EQUILIBRIUM_GAP / 10000.;
+    double gap = 1.;
+    int iteration;
+
+    for (iteration = 0; iteration <= EQUILIBRIUM_ITERATIONS; iteration++) {
+        // Charge tout-ou-rien sur les coûts du flux courant, un mouvement par recherche
+        equilibrium_update_costs(&eq);
+        eq.next = 0;
+        parallel_for((threads < count) ? threads : count, equilibrium_worker, &eq);
+        eq.routed += count;
+        equilibrium_load(&eq);
+
+        if (iteration == 0) {
+            memcpy(eq.flow, eq.load, sizeof(double) * size);
+            memcpy(eq.weighted, eq.load_weighted, sizeof(double) * size);
+            continue;
+        }
+
+        // Ecart relatif : temps total du flux courant comparé à celui des plus courts chemins
+        double total = 0.;
+        double shortest = 0.;
+        for (int c = 0; c < size; c++) {
+            if (env->agents[0][c] != -1) total += eq.costs[c] * eq.weighted[c];
+        }
+        for (int m = 0; m < count; m++) shortest += eq.movements[m].agents * eq.shortest[m];
+        gap = (total > 0.) ? (total - shortest) / total : 0.;
+        log_info("Equilibre : itération %d, écart relatif %.6f", iteration, gap);
+        if (gap <= target_gap || iteration == EQUILIBRIUM_ITERATIONS) break;
+
+        int active_count = 0;
+        for (int c = 0; c < size; c++) {
+            if (eq.load[c] != eq.flow[c] || eq.load_weighted[c] != eq.weighted[c]) active[active_count++] = c;
+        }
+        double step = (EQUILIBRIUM_METHOD == 1) ? equilibrium_line_search(&eq, active, active_count)
+                                                : 1. / (iteration + 1);
+        for (int k = 0; k < active_count; k++) {
+            int c = active[k];
+            eq.flow[c] += step * (eq.load[c] - eq.flow[c]);
+            eq.weighted[c] += step * (eq.load_weighted[c] - eq.weighted[c]);
+        }
+    }
+
+    // Le flux final est arrondi dans l'environnement
+    for (int c = 0; c < size; c++) {
+        if (env->agents[0][c] == -1) continue;
+        env->agents[0][c] += (int) (eq.flow[c] + 0.5);
+        if (env->agents[0][c] > env->max) env->max = env->agents[0][c];
+    }
+    long long agents = 0;
+    for (int m = 0; m < count; m++) agents += eq.movements[m].agents;
+    log_info("Affectation à l'équilibre : %d itérations, écart relatif %.6f, %lld recherches (%lld agents)",
+             iteration, gap, eq.routed, agents);
+
+    // Les mouvements sont consommés, comme par multiple_move_env_iterative_a_star
+    while (!ml_is_empty(movements)) ml_remove(movements);
+    for (int t = 0; t < threads; t++) {
+        free(eq.searches[t].dis);
+        free(eq.searches[t].pred);
+        free(eq.searches[t].seen);
+        free(eq.searches[t].closed);
+        pq_free(eq.searches[t].pq);
+    }
+    for (int m = 0; m < count; m++) free(eq.paths[m]);
+    free(active);
+    free(eq.searches);
+    free(eq.ids);
+    free(eq.paths);
+    free(eq.path_lengths);
+    free(eq.path_capacities);
+    free(eq.shortest);
+    free(eq.costs);
+    free(eq.load);
+    free(eq.load_weighted);
+    free(eq.weighted);
+    free(eq.flow);
+    cost_table_free(&eq.table);
+    log_debug("Déplacement d'agents par affectation à l'équilibre terminé");
+}
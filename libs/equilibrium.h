@@ -0,0 +1,56 @@
+#ifndef EQUILIBRIUM_H
+#define EQUILIBRIUM_H
+
+#include "crowd.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "cost.h"
+#include "common.h"
+
+// Nombre maximal d'itérations de l'affectation à l'équilibre (0 = désactivée, par défaut)
+extern int EQUILIBRIUM_ITERATIONS;
+
+// Pas de l'affectation : 0 = moyennes successives (MSA), 1 = Frank-Wolfe (recherche linéaire)
+extern int EQUILIBRIUM_METHOD;
+
+// Ecart relatif visé, en dix-millièmes (arrêt dès qu'il est atteint)
+extern int EQUILIBRIUM_GAP;
+
+// Recherche d'un fil d'exécution (un jeu de tableaux par fil)
+struct equilibrium_search_s {
+    double* dis;
+    int* pred;
+    int* seen;              // Dernière recherche ayant atteint la case
+    int* closed;            // Dernière recherche ayant développé la case
+    int epoch;
+    priority_queue_t* pq;
+};
+typedef struct equilibrium_search_s equilibrium_search_t;
+
+// Affectation à l'équilibre : chaque case porte un flux fractionnaire d'agents, les mouvements sont routés
+// en tout-ou-rien sur les coûts de ce flux, puis le flux est rapproché de la charge obtenue
+struct equilibrium_s {
+    environment_t* env;
+    movement_t* movements;
+    int count;
+    cost_table_t table;
+    double* flow;           // Agents par case, départ compris (comme env->agents)
+    double* weighted;       // Agents par case pondérés par la longueur du pas qui y mène (départ exclu)
+    double* load;           // Charge tout-ou-rien de l'itération
+    double* load_weighted;
+    double* costs;          // Coût courant de chaque case
+    double* shortest;       // Coût du plus court chemin de chaque mouvement
+    int** paths;            // Chemin de chaque mouvement (indices, de l'arrivée au départ)
+    int* path_lengths;
+    int* path_capacities;
+    int* ids;               // Indices des cases (valeurs de la file de priorité)
+    equilibrium_search_t* searches;
+    int next;               // Prochain mouvement à router (partagé)
+    long long routed;       // Recherches effectuées
+};
+typedef struct equilibrium_s equilibrium_t;
+
+// Appliquer plusieurs mouvements à un environnement par affectation à l'équilibre
+void multiple_move_env_equilibrium(movement_list_t* movements, environment_t* env, int weight0, int alpha);
+
+#endif
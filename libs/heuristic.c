@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#include "heuristic.h"
+#include "crowd.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "logging.h"
+#include "common.h"
+#include "instrument.h"
+#include "cost.h"
+
+int HEURISTIC_BUILDER = HEURISTIC_BUILDER_SEARCH;
+
+// Cases traitées ensemble par les relaxations verticales (registres de 32 octets avec AVX, par exemple
+// avec make native, de 16 octets sinon)
+#ifdef __AVX__
+#define HEURISTIC_LANES 4
+#else
+#define HEURISTIC_LANES 2
+#endif
+
+typedef double heuristic_lanes_t __attribute__((vector_size(HEURISTIC_LANES * sizeof(double))));
+typedef long long heuristic_mask_t __attribute__((vector_size(HEURISTIC_LANES * sizeof(long long))));
+
+// Distances et coûts des balayages de ce fil, bordés d'une case infinie de chaque côté
+thread_local double* heuristic_distance = NULL;
+thread_local double* heuristic_cost = NULL;
+thread_local int heuristic_capacity = 0;
+
+// Versions des lignes de ce fil : une ligne n'est relâchée depuis sa voisine que si celle-ci a changé depuis
+thread_local int* heuristic_version = NULL;
+thread_local int* heuristic_from_above = NULL;
+thread_local int* heuristic_from_below = NULL;
+thread_local int heuristic_rows = 0;
+
+// Lire et écrire des cases consécutives (sans contrainte d'alignement)
+static inline heuristic_lanes_t heuristic_load(const double* p) {
+    heuristic_lanes_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void heuristic_store(double* p, heuristic_lanes_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// Relâcher une ligne depuis sa voisine (from, de coûts c_from) : d[j] = min(d[j], from[j] + c[j]) et, en
+// 8-connexité, les diagonales dont aucun coin n'est un mur. Les lignes sont indépendantes case par case et
+// traitées HEURISTIC_LANES cases à la fois. Renvoie true si une distance a diminué
+bool heuristic_relax_row(double* d, const double* from, const double* c, const double* c_from, int cols,
+                         bool diagonals) {
+    const double diagonal = direction_lengths[4];
+    heuristic_lanes_t inf = (heuristic_lanes_t) {} + INFINITY;
+    heuristic_mask_t changed = {};
+    int j = 1;
+    for (; j + HEURISTIC_LANES - 1 <= cols; j += HEURISTIC_LANES) {
+        heuristic_lanes_t dv = heuristic_load(d + j);
+        heuristic_lanes_t cv = heuristic_load(c + j);
+        heuristic_lanes_t best = heuristic_load(from + j) + cv;
+        if (diagonals) {
+            heuristic_lanes_t step = cv * diagonal;
+            heuristic_mask_t wall = heuristic_load(c_from + j) == inf;
+            heuristic_lanes_t left = heuristic_load(from + j - 1) + step;
+            heuristic_lanes_t right = heuristic_load(from + j + 1) + step;
+            left = (wall | (heuristic_load(c + j - 1) == inf)) ? inf : left;
+            right = (wall | (heuristic_load(c + j + 1) == inf)) ? inf : right;
+            best = (left < best) ? left : best;
+            best = (right < best) ? right : best;
+        }
+        heuristic_mask_t better = best < dv;
+        changed |= better;
+        heuristic_store(d + j, better ? best : dv);
+    }
+    bool any = false;
+    for (int k = 0; k < HEURISTIC_LANES; k++) any = any || changed[k];
+
+    // Dernières cases de la ligne
+    for (; j <= cols; j++) {
+        double best = from[j] + c[j];
+        if (diagonals && c_from[j] != INFINITY) {
+            if (c[j - 1] != INFINITY && from[j - 1] + c[j] * diagonal < best) best = from[j - 1] + c[j] * diagonal;
+            if (c[j + 1] != INFINITY && from[j + 1] + c[j] * diagonal < best) best = from[j + 1] + c[j] * diagonal;
+        }
+        if (best < d[j]) {
+            d[j] = best;
+            any = true;
+        }
+    }
+    return any;
+}
+
+// Propager les distances le long d'une ligne, vers la droite puis vers la gauche
+bool heuristic_scan_row(double* d, const double* c, int cols) {
+    bool any = false;
+    for (int j = 1; j <= cols; j++) {
+        double v = d[j - 1] + c[j];
+        if (v < d[j]) {
+            d[j] = v;
+            any = true;
+        }
+    }
+    for (int j = cols; j >= 1; j--) {
+        double v = d[j + 1] + c[j];
+        if (v < d[j]) {
+            d[j] = v;
+            any = true;
+        }
+    }
+    return any;
+}
+
+// Distance de chaque case à une zone par balayages successifs des lignes
+int heuristic_sweep(environment_t* env, cost_table_t* costs, position_t target, position_t span, double** field) {
+    int width = env->cols + 2;
+    int size = (env->rows + 2) * width;
+    if (size > heuristic_capacity) {
+        free(heuristic_distance);
+        free(heuristic_cost);
+        heuristic_distance = (double*) malloc(sizeof(double) * size);
+        heuristic_cost = (double*) malloc(sizeof(double) * size);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) 2 * sizeof(double) * size);
+        heuristic_capacity = size;
+    }
+    if (env->rows + 2 > heuristic_rows) {
+        free(heuristic_version);
+        free(heuristic_from_above);
+        free(heuristic_from_below);
+        heuristic_version = (int*) malloc(sizeof(int) * (env->rows + 2));
+        heuristic_from_above = (int*) malloc(sizeof(int) * (env->rows + 2));
+        heuristic_from_below = (int*) malloc(sizeof(int) * (env->rows + 2));
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 3);
+        heuristic_rows = env->rows + 2;
+    }
+    int* version = heuristic_version;
+    int* from_above = heuristic_from_above;
+    int* from_below = heuristic_from_below;
+    for (int i = 0; i < env->rows + 2; i++) {
+        version[i] = 0;
+        from_above[i] = 0;
+        from_below[i] = 0;
+    }
+    double* d = heuristic_distance;
+    double* c = heuristic_cost;
+    for (int p = 0; p < size; p++) {
+        d[p] = INFINITY;
+        c[p] = INFINITY;
+    }
+    for (int i = 0; i < env->rows; i++) {
+        for (int j = 0; j < env->cols; j++) {
+            int agents = env->agents[i][j];
+            if (agents != -1) c[(i + 1) * width + j + 1] = cost_get(costs, agents);
+        }
+    }
+    // Les cases de la zone sont les sources
+    region_cells_t cells = region_cells(target, span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        d[(p.i + 1) * width + p.j + 1] = 0.;
+        version[p.i + 1] = 1;
+    }
+    for (int i = 1; i <= env->rows; i++) {
+        if (version[i] > 0) heuristic_scan_row(d + i * width, c + i * width, env->cols);
+    }
+
+    bool diagonals = CONNECTIVITY == 8;
+    int passes = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i <= env->rows; i++) {
+            if (from_above[i] == version[i - 1]) continue;
+            from_above[i] = version[i - 1];
+            double* row = d + i * width;
+            if (heuristic_relax_row(row, row - width, c + i * width, c + (i - 1) * width, env->cols, diagonals)) {
+                heuristic_scan_row(row, c + i * width, env->cols);
+                version[i]++;
+                changed = true;
+            }
+        }
+        for (int i = env->rows; i >= 1; i--) {
+            if (from_below[i] == version[i + 1]) continue;
+            from_below[i] = version[i + 1];
+            double* row = d + i * width;
+            if (heuristic_relax_row(row, row + width, c + i * width, c + (i + 1) * width, env->cols, diagonals)) {
+                heuristic_scan_row(row, c + i * width, env->cols);
+                version[i]++;
+                changed = true;
+            }
+        }
+        passes++;
+    }
+
+    for (int i = 0; i < env->rows; i++) {
+        double* row = d + (i + 1) * width + 1;
+        for (int j = 0; j < env->cols; j++) {
+            field[i][j] = (row[j] == INFINITY) ? 0. : row[j];
+        }
+    }
+    return passes;
+}
+
+// Mêmes distances par l'algorithme de Dijkstra (référence)
+void heuristic_dijkstra(environment_t* env, cost_table_t* costs, position_t target, position_t span, double** field) {
+    int size = env->rows * env->cols;
+    double* dis = (double*) malloc(sizeof(double) * size);
+    bool* closed = (bool*) calloc(size, sizeof(bool));
+    int* ids = (int*) malloc(sizeof(int) * size);
+    priority_queue_t* pq = pq_create(1024);
+    for (int c = 0; c < size; c++) {
+        dis[c] = INFINITY;
+        ids[c] = c;
+    }
+    region_cells_t cells = region_cells(target, span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        dis[p.i * env->cols + p.j] = 0.;
+        pq_push(pq, 0., (void*) &ids[p.i * env->cols + p.j]);
+    }
+    while (!pq_is_empty(pq)) {
+        int u = *(int*) pq_pop(pq);
+        if (closed[u]) continue;
+        closed[u] = true;
+        int ui = u / env->cols;
+        int uj = u % env->cols;
+        for (int d = 0; d < CONNECTIVITY; d++) {
+            if (!env_can_move(env, ui, uj, d)) continue;
+            int n = (ui + directions[d][0]) * env->cols + uj + directions[d][1];
+            double new_dist = dis[u] + cost_get(costs, env->agents[0][n]) * direction_lengths[d];
+            if (new_dist < dis[n]) {
+                dis[n] = new_dist;
+                pq_push(pq, new_dist, (void*) &ids[n]);
+            }
+        }
+    }
+    for (int i = 0; i < env->rows; i++) {
+        for (int j = 0; j < env->cols; j++) {
+            double value = dis[i * env->cols + j];
+            field[i][j] = (value == INFINITY) ? 0. : value;
+        }
+    }
+    pq_free(pq);
+    free(ids);
+    free(closed);
+    free(dis);
+}
+
+// Horloge monotone en millisecondes
+double heuristic_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+// Allouer un champ de distances
+double** heuristic_field_alloc(int rows, int cols) {
+    double** field = (double**) malloc(sizeof(double*) * rows);
+    double* cells = (double*) malloc(sizeof(double) * rows * cols);
+    for (int i = 0; i < rows; i++) field[i] = cells + (long long) i * cols;
+    return field;
+}
+
+// Comparer les deux constructions pour la zone d'arrivée de chaque mouvement (écart maximal et temps)
+void heuristic_compare(environment_t* env, movement_list_t* movements, int weight0, int alpha) {
+    cost_table_t costs = cost_table_create(weight0, alpha);
+    cost_table_reserve(&costs, env->max);
+    double** reference = heuristic_field_alloc(env->rows, env->cols);
+    double** swept = heuristic_field_alloc(env->rows, env->cols);
+    double dijkstra_total = 0.;
+    double sweep_total = 0.;
+    double worst = 0.;
+    int count = ml_remaining(movements);
+    printf("cible;dijkstra_ms;balayages_ms;allers_retours;ecart_maximal\n");
+    for (int m = 0; m < count; m++) {
+        movement_t* movement = &movements->items[movements->first + m];
+        double start = heuristic_clock();
+        heuristic_dijkstra(env, &costs, movement->target, movement->target_span, reference);
+        double middle = heuristic_clock();
+        int passes = heuristic_sweep(env, &costs, movement->target, movement->target_span, swept);
+        double end = heuristic_clock();
+
+        // Ecart relatif à la distance, les sommes n'étant pas faites dans le même ordre
+        double gap = 0.;
+        for (int i = 0; i < env->rows; i++) {
+            for (int j = 0; j < env->cols; j++) {
+                double scale = (reference[i][j] > 1.) ? reference[i][j] : 1.;
+                double difference = fabs(reference[i][j] - swept[i][j]) / scale;
+                if (difference > gap) gap = difference;
+            }
+        }
+        printf("%d:%d;%.3f;%.3f;%d;%.3g\n", movement->target.i, movement->target.j, middle - start, end - middle,
+               passes, gap);
+        dijkstra_total += middle - start;
+        sweep_total += end - middle;
+        if (gap > worst) worst = gap;
+    }
+    log_info("Heuristique : Dijkstra %.1f ms, balayages %.1f ms pour %d cibles, écart relatif maximal %.3g",
+             dijkstra_total, sweep_total, count, worst);
+    free(reference[0]);
+    free(reference);
+    free(swept[0]);
+    free(swept);
+    cost_table_free(&costs);
+}
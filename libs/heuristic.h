@@ -0,0 +1,29 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "crowd.h"
+#include "movement_list.h"
+#include "cost.h"
+#include "common.h"
+
+// Construction du champ d'heuristique lors des recalculs du A* itératif
+enum heuristic_builder_e {
+    HEURISTIC_BUILDER_SEARCH,   // Recherche inverse depuis la zone d'arrivée (par défaut)
+    HEURISTIC_BUILDER_SWEEP,    // Balayages des lignes jusqu'à convergence
+};
+
+// Construction utilisée par le A* itératif
+extern int HEURISTIC_BUILDER;
+
+// Distance de chaque case à une zone (coût des cases traversées, zone exclue) par balayages successifs des
+// lignes vers le bas puis vers le haut, jusqu'à ce qu'aucune distance ne diminue. Les cases inaccessibles
+// reçoivent 0. Renvoie le nombre d'allers-retours
+int heuristic_sweep(environment_t* env, cost_table_t* costs, position_t target, position_t span, double** field);
+
+// Mêmes distances par l'algorithme de Dijkstra (référence)
+void heuristic_dijkstra(environment_t* env, cost_table_t* costs, position_t target, position_t span, double** field);
+
+// Comparer les deux constructions pour la zone d'arrivée de chaque mouvement (écart maximal et temps)
+void heuristic_compare(environment_t* env, movement_list_t* movements, int weight0, int alpha);
+
+#endif
@@ -6,12 +6,16 @@
 
 #include "image.h"
 #include "logging.h"
+#include "resample.h"
+#include "instrument.h"
 
 // Fonctions pratiques
 
 // Copier une image en niveaux de gris
 image_t image_copy(image_t image) {
     log_debug("Copie de l'image : %s", image.name);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, image.rows + 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) image.rows * image.cols * sizeof(pixel_t));
     image_t copy = {
         .name = image.name,
         .rows = image.rows,
@@ -31,6 +35,8 @@ image_t image_copy(image_t image) {
 // Copier une image colorée
 colored_image_t colored_image_copy(colored_image_t image) {
     log_debug("Copie de l'image colorée : %s", image.name);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, image.rows + 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) image.rows * image.cols * sizeof(colored_pixel_t));
     colored_image_t copy = {
         .name = image.name,
         .rows = image.rows,
@@ -85,6 +91,8 @@ void kernel_free(kernel_t kernel) {
 colored_image_t colored_image_from_mat(cv::Mat mat) {
     log_debug("Conversion d'un cv::Mat en colored_image_t");
     if (mat.empty()) log_fatal("Erreur lors de la conversion : cv::Mat vide");
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, mat.rows + 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) mat.rows * mat.cols * sizeof(colored_pixel_t));
 
     colored_image_t image = {
         .name = NULL,
@@ -153,6 +161,9 @@ cv::Mat cvmat_from_image(image_t image) {
 // Convertir un colored_image_t en image_t (niveaux de gris avec pondérations)
 image_t image_from_colored_image(colored_image_t colored_image) {
     log_debug("Conversion d'un colored_image_t en image_t : %s", colored_image.name);
+    INSTR_SCOPE(INSTR_STAGE_GREY);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, colored_image.rows + 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) colored_image.rows * colored_image.cols * sizeof(pixel_t));
     image_t image = {
         .name = colored_image.name,
         .rows = colored_image.rows,
@@ -176,15 +187,23 @@ image_t image_from_colored_image(colored_image_t colored_image) {
 
 // Lire une image en niveaux de gris
 colored_image_t image_read(const char* path) {
+    colored_image_t image;
+    if (!image_try_read(path, &image)) log_fatal("Erreur lors de la lecture de l'image : %s", path);
+    return image;
+}
+
+// Lire une image colorée sans arrêter le programme : false si elle est illisible
+bool image_try_read(const char* path, colored_image_t* image) {
     // Lire l'image avec OpenCV
     log_debug("Lecture de l'image : %s", path);
+    INSTR_SCOPE(INSTR_STAGE_IMAGE_READ);
 
     cv::Mat mat = cv::imread(path, cv::IMREAD_COLOR);
-    if (mat.empty()) log_fatal("Erreur lors de la lecture de l'image : %s", path);
+    if (mat.empty()) return false;
 
-    colored_image_t image = colored_image_from_mat(mat);
-    image.name = strdup(path); // Dupliquer le nom du fichier
-    return image;
+    *image = colored_image_from_mat(mat);
+    image->name = strdup(path); // Dupliquer le nom du fichier
+    return true;
 }
 
 // Ecrire une image en niveaux de gris
@@ -246,32 +265,8 @@ image_t image_resize(image_t image, int scale) {
     log_debug("Redimensionnement de l'image : %s avec un facteur de réduction de %d", image.name, scale);
     if (scale <= 0) log_fatal("Erreur de redimensionnement : facteur de réduction invalide (%d)", scale);
 
-    int new_rows = image.rows / scale;
-    int new_cols = image.cols / scale;
-    image_t scaled = {
-        .name = image.name,
-        .rows = new_rows,
-        .cols = new_cols,
-        .pixels = (pixel_t**) malloc(sizeof(pixel_t*) * new_rows),
-    };
-    // Parcours des pixels
-    for (int i = 0; i < new_rows; i++) {
-        scaled.pixels[i] = (pixel_t*) malloc(sizeof(pixel_t) * new_cols);
-        for (int j = 0; j < new_cols; j++) {
-            // Moyenne des pixels voisins
-            pixel_t pixel_moyen = 0.;
-            int count = 0;
-            for (int x = 0; x < scale && i * scale + x < image.rows; x++) {
-                for (int y = 0; y < scale && j * scale + y < image.cols; y++) {
-                    pixel_t p = image.pixels[i * scale + x][j * scale + y];
-                    pixel_moyen += p;
-                    count++;
-                }
-            }
-            pixel_moyen /= count;
-            scaled.pixels[i][j] = pixel_moyen;
-        }
-    }
+    // Moyenne des pixels voisins par la réduction à facteur réel
+    image_t scaled = image_resample(image, (double) scale);
     log_debug("Image redimensionnée : %s avec un facteur de réduction de %d", image.name, scale);
     return scaled;
 }
@@ -54,6 +54,7 @@ image_t image_from_colored_image(colored_image_t colored_image);
 
 // Fonctions de lecture et d'écriture d'images
 colored_image_t image_read(const char* filename);
+bool image_try_read(const char* filename, colored_image_t* image);
 void image_write(image_t image, const char* filename);
 void colored_image_write(colored_image_t image, const char* filename);
 
@@ -1,15 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <math.h>
 
 
 #include "image.h"
 #include "image_usage.h"
+#include "arena.h"
 #include "queue.h"
 #include "priority_queue.h"
 #include "logging.h"
 #include "common.h"
+#include "instrument.h"
 
 
 // Créer un noyau gaussien de taille size et d'écart-type sigma
@@ -208,53 +211,50 @@ void image_double_threshold(image_t image, double t_max, double t_min) {
 
 // Tracer les contours en contact avec un pixel fort
 void image_hysteresis_aux(image_t image, bool** visited, int i, int j, queue_t* queue) {
-    position_t* pos = (position_t*) malloc(sizeof(position_t));
-    pos->i = i;
-    pos->j = j;
-    queue_enqueue(queue, (void*) pos);
+    position_t start = {.i = i, .j = j};
+    queue_enqueue(queue, &start);
     visited[i][j] = true;
 
     while (!queue_is_empty(queue)) {
-        position_t* p = (position_t*) queue_dequeue(queue);
-        image.pixels[p->i][p->j] = 1.; // Marquer le pixel comme fort
+        position_t p = *(position_t*) queue_dequeue(queue);
+        image.pixels[p.i][p.j] = 1.; // Marquer le pixel comme fort
 
         // Vérifier les voisins
         for (int di = -1; di <= 1; di++) {
             for (int dj = -1; dj <= 1; dj++) {
                 if (di == 0 && dj == 0) continue; // Ignorer le pixel central
-                int ni = p->i + di;
-                int nj = p->j + dj;
+                int ni = p.i + di;
+                int nj = p.j + dj;
 
                 if (ni >= 0 && ni < image.rows && nj >= 0 && nj < image.cols &&
                     !visited[ni][nj] && image.pixels[ni][nj] != 0) {
                     visited[ni][nj] = true;
-
-                    position_t* new_pos = (position_t*) malloc(sizeof(position_t));
-                    new_pos->i = ni;
-                    new_pos->j = nj;
-
-                    queue_enqueue(queue, (void*) new_pos);
+                    position_t neighbour = {.i = ni, .j = nj};
+                    queue_enqueue(queue, &neighbour);
                 }
             }
         }
-        free(p);
     }
 }
 
+// Zone de ce fil pour la matrice des pixels visités : remise à zéro à chaque hystérésis, ses blocs servent
+// aux suivantes (une par bande avec le Canny par bandes)
+thread_local arena_t* hysteresis_arena = NULL;
+
 // Tracer les contours d'une image avec une hystérésis
 void image_hysteresis(image_t image) {
     log_debug("Application de l'hystérésis sur l'image : %s", image.name);
+    if (hysteresis_arena == NULL) hysteresis_arena = arena_create(1 << 16);
+    arena_reset(hysteresis_arena);
+
     // Initialiser la matrice des pixels visités
-    bool** visited = (bool**) malloc(sizeof(bool*) * image.rows);
-    for (int i = 0; i < image.rows; i++) {
-        visited[i] = (bool*) malloc(sizeof(bool) * image.cols);
-        for (int j = 0; j < image.cols; j++) {
-            visited[i][j] = false;
-        }
-    }
+    bool** visited = (bool**) arena_alloc(hysteresis_arena, sizeof(bool*) * image.rows);
+    bool* cells = (bool*) arena_alloc(hysteresis_arena, sizeof(bool) * image.rows * image.cols);
+    memset(cells, 0, sizeof(bool) * image.rows * image.cols);
+    for (int i = 0; i < image.rows; i++) visited[i] = cells + (long long) i * image.cols;
 
-    // Initialiser la queue
-    queue_t* queue = queue_create();
+    // File des pixels à visiter : seuls les pixels en attente occupent de la mémoire
+    queue_t* queue = queue_create(sizeof(position_t));
 
     // Pour chaque pixel fort, rendre fort les pixels faibles connectés
     for (int i = 0; i < image.rows; i++) {
@@ -272,11 +272,6 @@ void image_hysteresis(image_t image) {
         }
     }
 
-    // Libérer les ressources
-    for (int i = 0; i < image.rows; i++) {
-        free(visited[i]);
-    }
-    free(visited);
     queue_free(queue);
 
     log_debug("Hystérésis appliquée sur l'image : %s", image.name);
@@ -285,30 +280,43 @@ void image_hysteresis(image_t image) {
 // Application du filtre de Canny
 image_t canny(image_t image, double t_max, double t_min) {
     log_debug("Application du filtre de Canny sur l'image : %s", image.name);
+    INSTR_SCOPE(INSTR_STAGE_CANNY);
 
     // Flou gaussien
+    INSTR_TIMER_START(blur_start);
     kernel_t kernel = create_gaussian_kernel(5, 1.0);
     image_t blured_image = image_apply_filter(image, kernel);
     kernel_free(kernel);
+    INSTR_TIMER_STOP(blur_start, INSTR_STAGE_CANNY_BLUR);
 
     // Appliquer le filtre de Sobel
+    INSTR_TIMER_START(sobel_start);
     image_t gradient_x, gradient_y;
     image_apply_sobel(blured_image, &gradient_x, &gradient_y);
+    INSTR_TIMER_STOP(sobel_start, INSTR_STAGE_CANNY_SOBEL);
 
     // Calculer la direction des gradients
+    INSTR_TIMER_START(direction_start);
     image_t direction = image_compute_gradient_direction(gradient_x, gradient_y);
     image_free(gradient_x);
     image_free(gradient_y);
+    INSTR_TIMER_STOP(direction_start, INSTR_STAGE_CANNY_DIRECTION);
 
     // Suppression des non-maxima locaux
+    INSTR_TIMER_START(nms_start);
     image_t non_maxima = image_non_maxima_suppression(blured_image, direction);
     image_free(blured_image);
+    INSTR_TIMER_STOP(nms_start, INSTR_STAGE_CANNY_NMS);
 
     // Appliquer un double seuil
+    INSTR_TIMER_START(threshold_start);
     image_double_threshold(non_maxima, t_max, t_min);
+    INSTR_TIMER_STOP(threshold_start, INSTR_STAGE_CANNY_THRESHOLD);
 
     // Appliquer l'hystérésis
+    INSTR_TIMER_START(hysteresis_start);
     image_hysteresis(non_maxima);
+    INSTR_TIMER_STOP(hysteresis_start, INSTR_STAGE_CANNY_HYSTERESIS);
 
     log_debug("Filtre de Canny appliqué sur l'image : %s", image.name);
 
@@ -318,6 +326,7 @@ image_t canny(image_t image, double t_max, double t_min) {
 // Rendre continue les contours de l'image
 image_t image_fermeture_morphologique(image_t image, int size) {
     log_debug("Application de la fermeture morphologique sur l'image : %s", image.name);
+    INSTR_SCOPE(INSTR_STAGE_CLOSING);
     image_t result_dilatation = image_copy(image);
 
     // Dilatation
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdbool.h>
+
+#include "instrument.h"
+
+#ifdef INSTRUMENTATION
+
+long long instrument_counters[INSTR_COUNTER_COUNT];
+long long instrument_totals[INSTR_STAGE_COUNT];
+long long instrument_calls[INSTR_STAGE_COUNT];
+long long instrument_max[INSTR_STAGE_COUNT];
+
+const char* instrument_counter_names[INSTR_COUNTER_COUNT] = {
+    "expanded", "pushes", "pops", "paths", "path_cells", "heuristic_refreshes", "path_cache_hits",
+    "allocations", "allocated_bytes"
+};
+
+const char* instrument_stage_names[INSTR_STAGE_COUNT] = {
+    "image_read", "grey", "canny", "canny_blur", "canny_sobel", "canny_direction", "canny_nms",
+    "canny_threshold", "canny_hysteresis", "closing", "env_from_image", "routing", "movement",
+    "heuristic_refresh", "render"
+};
+
+// Horloge monotone en nanosecondes
+long long instrument_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Ajouter n à un compteur (atomique)
+void instrument_add(int counter, long long n) {
+    __atomic_fetch_add(&instrument_counters[counter], n, __ATOMIC_RELAXED);
+}
+
+// Ajouter une durée (en nanosecondes) à une étape (atomique)
+void instrument_stage_add(int stage, long long ns) {
+    __atomic_fetch_add(&instrument_totals[stage], ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&instrument_calls[stage], 1, __ATOMIC_RELAXED);
+    long long current = __atomic_load_n(&instrument_max[stage], __ATOMIC_RELAXED);
+    while (ns > current && !__atomic_compare_exchange_n(&instrument_max[stage], &current, ns, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// Lire un compteur
+long long instrument_counter(int counter) {
+    return __atomic_load_n(&instrument_counters[counter], __ATOMIC_RELAXED);
+}
+
+// Lire la durée cumulée d'une étape
+long long instrument_stage_total(int stage) {
+    return __atomic_load_n(&instrument_totals[stage], __ATOMIC_RELAXED);
+}
+
+// Lire le nombre de passages dans une étape
+long long instrument_stage_calls(int stage) {
+    return __atomic_load_n(&instrument_calls[stage], __ATOMIC_RELAXED);
+}
+
+// Lire la durée maximale d'un passage dans une étape
+long long instrument_stage_max(int stage) {
+    return __atomic_load_n(&instrument_max[stage], __ATOMIC_RELAXED);
+}
+
+// Nom d'une étape
+const char* instrument_stage_name(int stage) {
+    return instrument_stage_names[stage];
+}
+
+// Remettre tous les compteurs et chronomètres à zéro
+void instrument_reset() {
+    for (int c = 0; c < INSTR_COUNTER_COUNT; c++) {
+        __atomic_store_n(&instrument_counters[c], 0, __ATOMIC_RELAXED);
+    }
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) {
+        __atomic_store_n(&instrument_totals[s], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&instrument_calls[s], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&instrument_max[s], 0, __ATOMIC_RELAXED);
+    }
+}
+
+// Ecrire les compteurs et chronomètres au format JSON
+void instrument_dump(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Erreur lors de l'ouverture du fichier d'instrumentation : %s\n", path);
+        return;
+    }
+    fprintf(file, "{\n  \"counters\": {");
+    for (int c = 0; c < INSTR_COUNTER_COUNT; c++) {
+        fprintf(file, "%s\n    \"%s\": %lld", c == 0 ? "" : ",", instrument_counter_names[c], instrument_counter(c));
+    }
+    fprintf(file, "\n  },\n  \"stages\": {");
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) {
+        fprintf(file, "%s\n    \"%s\": {\"calls\": %lld, \"total_ns\": %lld, \"max_ns\": %lld}",
+                s == 0 ? "" : ",", instrument_stage_names[s], instrument_stage_calls(s),
+                instrument_stage_total(s), instrument_stage_max(s));
+    }
+    fprintf(file, "\n  }\n}\n");
+    fclose(file);
+}
+
+// Ecriture automatique à la fin du programme (si quelque chose a été mesuré)
+void instrument_dump_at_exit() {
+    bool used = false;
+    for (int c = 0; c < INSTR_COUNTER_COUNT; c++) used = used || instrument_counter(c) != 0;
+    for (int s = 0; s < INSTR_STAGE_COUNT; s++) used = used || instrument_stage_calls(s) != 0;
+    if (used) instrument_dump(INSTRUMENT_OUTPUT);
+}
+
+__attribute__((constructor)) void instrument_register() {
+    atexit(instrument_dump_at_exit);
+}
+
+#endif // INSTRUMENTATION
@@ -0,0 +1,97 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// Instrumentation des étapes et des compteurs, compilée seulement avec -DINSTRUMENTATION.
+// Sans ce drapeau, les macros INSTR_* ne produisent aucun code.
+
+// Fichier écrit à la fin du programme
+#define INSTRUMENT_OUTPUT "instrumentation.json"
+
+// Compteurs
+enum instrument_counter_e {
+    INSTR_COUNTER_EXPANDED,             // Cellules développées par les recherches
+    INSTR_COUNTER_PUSHES,               // Insertions dans les files de priorité
+    INSTR_COUNTER_POPS,                 // Extractions des files de priorité
+    INSTR_COUNTER_PATHS,                // Chemins appliqués à l'environnement
+    INSTR_COUNTER_PATH_CELLS,           // Longueur cumulée des chemins appliqués
+    INSTR_COUNTER_HEURISTIC_REFRESHES,  // Recalculs de l'heuristique
+    INSTR_COUNTER_PATH_CACHE_HITS,      // Chemins repris du cache sans recherche
+    INSTR_COUNTER_ALLOCATIONS,          // Allocations des images, environnements et structures
+    INSTR_COUNTER_ALLOCATED_BYTES,
+    INSTR_COUNTER_COUNT
+};
+
+// Etapes chronométrées
+enum instrument_stage_e {
+    INSTR_STAGE_IMAGE_READ,
+    INSTR_STAGE_GREY,
+    INSTR_STAGE_CANNY,
+    INSTR_STAGE_CANNY_BLUR,
+    INSTR_STAGE_CANNY_SOBEL,
+    INSTR_STAGE_CANNY_DIRECTION,
+    INSTR_STAGE_CANNY_NMS,
+    INSTR_STAGE_CANNY_THRESHOLD,
+    INSTR_STAGE_CANNY_HYSTERESIS,
+    INSTR_STAGE_CLOSING,
+    INSTR_STAGE_ENV_FROM_IMAGE,
+    INSTR_STAGE_ROUTING,
+    INSTR_STAGE_MOVEMENT,
+    INSTR_STAGE_HEURISTIC_REFRESH,
+    INSTR_STAGE_RENDER,
+    INSTR_STAGE_COUNT
+};
+
+#ifdef INSTRUMENTATION
+
+// Horloge monotone en nanosecondes
+long long instrument_now();
+
+// Ajouter n à un compteur (atomique)
+void instrument_add(int counter, long long n);
+
+// Ajouter une durée (en nanosecondes) à une étape (atomique)
+void instrument_stage_add(int stage, long long ns);
+
+// Lire un compteur
+long long instrument_counter(int counter);
+
+// Lire la durée cumulée, le nombre de passages et la durée maximale d'une étape
+long long instrument_stage_total(int stage);
+long long instrument_stage_calls(int stage);
+long long instrument_stage_max(int stage);
+
+// Nom d'une étape
+const char* instrument_stage_name(int stage);
+
+// Remettre tous les compteurs et chronomètres à zéro
+void instrument_reset();
+
+// Ecrire les compteurs et chronomètres au format JSON
+void instrument_dump(const char* path);
+
+// Chronomètre lié à une portée : la durée est ajoutée à l'étape à la sortie de la portée
+struct instrument_scope_s {
+    int stage;
+    long long start;
+    instrument_scope_s(int s) : stage(s), start(instrument_now()) {}
+    ~instrument_scope_s() { instrument_stage_add(stage, instrument_now() - start); }
+};
+typedef struct instrument_scope_s instrument_scope_t;
+
+#define INSTR_CONCAT_(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT_(a, b)
+#define INSTR_COUNT(counter, n) instrument_add((counter), (n))
+#define INSTR_SCOPE(stage) instrument_scope_t INSTR_CONCAT(instr_scope_, __LINE__)(stage)
+#define INSTR_TIMER_START(name) long long name = instrument_now()
+#define INSTR_TIMER_STOP(name, stage) instrument_stage_add((stage), instrument_now() - (name))
+
+#else
+
+#define INSTR_COUNT(counter, n) ((void) 0)
+#define INSTR_SCOPE(stage) ((void) 0)
+#define INSTR_TIMER_START(name) ((void) 0)
+#define INSTR_TIMER_STOP(name, stage) ((void) 0)
+
+#endif // INSTRUMENTATION
+
+#endif // INSTRUMENT_H
@@ -1,67 +1,178 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "logging.h"
 #include "config.h"
 
 #define LOG_BUFFER_SIZE 4096 // On suppose que 4096 est suffisant pour la plupart des messages
+#define LOG_ASYNC_SLOTS 256  // Messages en attente avant que les appelants ne soient bloqués
 
-// Affiche un message de debug (niveau 2)
-void log_debug(const char* message, ...) {
-    if (DEBUG_MODE >= 2) {
-        char buffer[LOG_BUFFER_SIZE];
-        va_list args;
-        va_start(args, message);
-        vsnprintf(buffer, LOG_BUFFER_SIZE, message, args);
-        va_end(args);
-        fprintf(stderr, "[DEBUG] %s\n", buffer);
+int LOG_ASYNC = 0; // Ecriture directe par défaut
+
+// File des messages en attente d'écriture
+struct log_sink_s {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    bool running;
+    bool stopping;
+    int head;
+    int count;
+    char slots[LOG_ASYNC_SLOTS][LOG_BUFFER_SIZE];
+};
+typedef struct log_sink_s log_sink_t;
+
+log_sink_t* log_sink = NULL;
+
+// Fil d'écriture : regroupe les messages en attente en une seule écriture
+void* log_sink_run(void* arg) {
+    log_sink_t* sink = (log_sink_t*) arg;
+    char* batch = (char*) malloc(LOG_ASYNC_SLOTS * (LOG_BUFFER_SIZE + 1));
+
+    pthread_mutex_lock(&sink->mutex);
+    while (true) {
+        while (sink->count == 0 && !sink->stopping) {
+            pthread_cond_wait(&sink->not_empty, &sink->mutex);
+        }
+        if (sink->count == 0 && sink->stopping) break;
+
+        size_t len = 0;
+        while (sink->count > 0) {
+            size_t size = strlen(sink->slots[sink->head]);
+            memcpy(batch + len, sink->slots[sink->head], size);
+            len += size;
+            batch[len++] = '\n';
+            sink->head = (sink->head + 1) % LOG_ASYNC_SLOTS;
+            sink->count--;
+        }
+        pthread_cond_broadcast(&sink->not_full);
+
+        pthread_mutex_unlock(&sink->mutex);
+        fwrite(batch, 1, len, stderr);
+        fflush(stderr);
+        pthread_mutex_lock(&sink->mutex);
     }
+    pthread_mutex_unlock(&sink->mutex);
+
+    free(batch);
+    return NULL;
 }
 
-// Affiche un message d'erreur (niveau 1)
-void log_error(const char* message, ...) {
-    if (DEBUG_MODE >= 1) {
+// Préparer un fork : la file ne doit pas être copiée en cours de modification
+void log_sink_prepare_fork() {
+    if (log_sink != NULL) pthread_mutex_lock(&log_sink->mutex);
+}
+
+// Après un fork, côté parent
+void log_sink_parent_fork() {
+    if (log_sink != NULL) pthread_mutex_unlock(&log_sink->mutex);
+}
+
+// Après un fork, côté fils : le fil d'écriture n'existe pas, on écrit directement
+void log_sink_child_fork() {
+    if (log_sink != NULL) pthread_mutex_unlock(&log_sink->mutex);
+    log_sink = NULL;
+}
+
+// Démarrer l'écriture asynchrone des messages (vidée à la fin du programme)
+void log_async_start() {
+    if (log_sink != NULL) return;
+    log_sink_t* sink = (log_sink_t*) malloc(sizeof(log_sink_t));
+    pthread_mutex_init(&sink->mutex, NULL);
+    pthread_cond_init(&sink->not_empty, NULL);
+    pthread_cond_init(&sink->not_full, NULL);
+    sink->running = true;
+    sink->stopping = false;
+    sink->head = 0;
+    sink->count = 0;
+    pthread_create(&sink->thread, NULL, log_sink_run, sink);
+    log_sink = sink;
+    pthread_atfork(log_sink_prepare_fork, log_sink_parent_fork, log_sink_child_fork);
+    atexit(log_async_stop);
+}
+
+// Arrêter l'écriture asynchrone après avoir écrit les messages en attente
+void log_async_stop() {
+    log_sink_t* sink = log_sink;
+    if (sink == NULL) return;
+
+    pthread_mutex_lock(&sink->mutex);
+    sink->stopping = true;
+    pthread_cond_signal(&sink->not_empty);
+    pthread_mutex_unlock(&sink->mutex);
+    pthread_join(sink->thread, NULL);
+
+    log_sink = NULL;
+    pthread_mutex_destroy(&sink->mutex);
+    pthread_cond_destroy(&sink->not_empty);
+    pthread_cond_destroy(&sink->not_full);
+    free(sink);
+}
+
+// Formater puis écrire un message (directement ou par le fil d'écriture)
+void log_emit(const char* level, const char* message, va_list args) {
+    log_sink_t* sink = log_sink;
+    if (sink == NULL) {
         char buffer[LOG_BUFFER_SIZE];
-        va_list args;
-        va_start(args, message);
         vsnprintf(buffer, LOG_BUFFER_SIZE, message, args);
-        va_end(args);
-        fprintf(stderr, "[ERROR] %s\n", buffer);
+        fprintf(stderr, "[%s] %s\n", level, buffer);
+        return;
+    }
+
+    pthread_mutex_lock(&sink->mutex);
+    while (sink->count == LOG_ASYNC_SLOTS) {
+        pthread_cond_wait(&sink->not_full, &sink->mutex);
     }
+    char* slot = sink->slots[(sink->head + sink->count) % LOG_ASYNC_SLOTS];
+    int len = snprintf(slot, LOG_BUFFER_SIZE, "[%s] ", level);
+    vsnprintf(slot + len, LOG_BUFFER_SIZE - len, message, args);
+    sink->count++;
+    pthread_cond_signal(&sink->not_empty);
+    pthread_mutex_unlock(&sink->mutex);
+}
+
+// Affiche un message de debug (niveau 2)
+void log_debug_message(const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    log_emit("DEBUG", message, args);
+    va_end(args);
+}
+
+// Affiche un message d'erreur (niveau 1)
+void log_error_message(const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    log_emit("ERROR", message, args);
+    va_end(args);
 }
 
 // Affiche un message d'information (niveau 0)
-void log_info(const char* message, ...) {
-    if (DEBUG_MODE >= 0) {
-        char buffer[LOG_BUFFER_SIZE];
-        va_list args;
-        va_start(args, message);
-        vsnprintf(buffer, LOG_BUFFER_SIZE, message, args);
-        va_end(args);
-        fprintf(stderr, "[INFO] %s\n", buffer);
-    }
+void log_info_message(const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    log_emit("INFO", message, args);
+    va_end(args);
 }
 
 // Affiche un message d'avertissement (niveau 0)
-void log_warning(const char* message, ...) {
-    if (DEBUG_MODE >= 0) {
-        char buffer[LOG_BUFFER_SIZE];
-        va_list args;
-        va_start(args, message);
-        vsnprintf(buffer, LOG_BUFFER_SIZE, message, args);
-        va_end(args);
-        fprintf(stderr, "[WARNING] %s\n", buffer);
-    }
+void log_warning_message(const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    log_emit("WARNING", message, args);
+    va_end(args);
 }
 
-// Affiche un message fatal et termine le programme
+// Affiche un message fatal et termine le programme (les messages en attente sont écrits)
 void log_fatal(const char* message, ...) {
-    char buffer[LOG_BUFFER_SIZE];
     va_list args;
     va_start(args, message);
-    vsnprintf(buffer, LOG_BUFFER_SIZE, message, args);
+    log_emit("FATAL", message, args);
     va_end(args);
-    fprintf(stderr, "[FATAL] %s\n", buffer);
     exit(EXIT_FAILURE);
-}
\ No newline at end of file
+}
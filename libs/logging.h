@@ -1,12 +1,42 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include "config.h"
 
-void log_debug(const char* message, ...);
-void log_error(const char* message, ...);
-void log_info(const char* message, ...);
-void log_warning(const char* message, ...);
-void log_fatal(const char* message, ...);
+// Niveau de débogage maximal compilé : les messages qui demandent un DEBUG_MODE plus élevé
+// disparaissent à la compilation, arguments compris (ex. -DLOG_COMPILED_MODE=1 retire log_debug)
+#ifndef LOG_COMPILED_MODE
+#define LOG_COMPILED_MODE 2
+#endif
 
+// Ecriture des messages par un fil d'exécution dédié (0 = écriture directe)
+extern int LOG_ASYNC;
 
-#endif
\ No newline at end of file
+// Les macros testent le niveau avant d'évaluer les arguments du message
+#define log_debug(...) do { \
+        if (LOG_COMPILED_MODE >= 2 && DEBUG_MODE >= 2) log_debug_message(__VA_ARGS__); \
+    } while (0)
+#define log_error(...) do { \
+        if (LOG_COMPILED_MODE >= 1 && DEBUG_MODE >= 1) log_error_message(__VA_ARGS__); \
+    } while (0)
+#define log_info(...) do { \
+        if (DEBUG_MODE >= 0) log_info_message(__VA_ARGS__); \
+    } while (0)
+#define log_warning(...) do { \
+        if (DEBUG_MODE >= 0) log_warning_message(__VA_ARGS__); \
+    } while (0)
+
+void log_debug_message(const char* message, ...);
+void log_error_message(const char* message, ...);
+void log_info_message(const char* message, ...);
+void log_warning_message(const char* message, ...);
+void log_fatal(const char* message, ...) __attribute__((noreturn));
+
+// Démarrer l'écriture asynchrone des messages (vidée à la fin du programme)
+void log_async_start();
+
+// Arrêter l'écriture asynchrone après avoir écrit les messages en attente
+void log_async_stop();
+
+
+#endif
@@ -0,0 +1,76 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "movement_list.h"
+#include "common.h"
+#include "instrument.h"
+
+// Créer une liste de mouvements vide
+movement_list_t* ml_create(int capacity) {
+    if (capacity < 1) capacity = 1;
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, sizeof(movement_list_t) + sizeof(movement_t) * capacity);
+    movement_list_t* ml = (movement_list_t*) malloc(sizeof(movement_list_t));
+    ml->items = (movement_t*) malloc(sizeof(movement_t) * capacity);
+    ml->size = 0;
+    ml->capacity = capacity;
+    ml->first = 0;
+    return ml;
+}
+
+// Ajouter un mouvement en fin de liste
+void ml_add(movement_list_t* ml, movement_t movement) {
+    if (ml->size == ml->capacity) {
+        ml->capacity *= 2;
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, sizeof(movement_t) * ml->capacity);
+        ml->items = (movement_t*) realloc(ml->items, sizeof(movement_t) * ml->capacity);
+    }
+    ml->items[ml->size++] = movement;
+}
+
+// Récupérer le premier mouvement restant (NULL si la liste est vide)
+movement_t* ml_get(movement_list_t* ml) {
+    if (ml_is_empty(ml)) return NULL;
+    return &ml->items[ml->first];
+}
+
+// Retirer le premier mouvement restant
+void ml_remove(movement_list_t* ml) {
+    if (ml_is_empty(ml)) return;
+    ml->first++;
+}
+
+// Nombre de mouvements restants
+int ml_remaining(movement_list_t* ml) {
+    return ml->size - ml->first;
+}
+
+// Vérifier s'il reste des mouvements
+bool ml_is_empty(movement_list_t* ml) {
+    return ml->first >= ml->size;
+}
+
+// Inverser l'ordre des mouvements restants
+void ml_reverse(movement_list_t* ml) {
+    for (int a = ml->first, b = ml->size - 1; a < b; a++, b--) {
+        movement_t m = ml->items[a];
+        ml->items[a] = ml->items[b];
+        ml->items[b] = m;
+    }
+}
+
+// Copier les mouvements restants
+movement_list_t* ml_copy(movement_list_t* ml) {
+    movement_list_t* copy = ml_create(ml_remaining(ml));
+    memcpy(copy->items, ml->items + ml->first, sizeof(movement_t) * ml_remaining(ml));
+    copy->size = ml_remaining(ml);
+    return copy;
+}
+
+// Libérer la liste
+void ml_free(movement_list_t* ml) {
+    free(ml->items);
+    free(ml);
+}
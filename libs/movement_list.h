@@ -0,0 +1,44 @@
+#ifndef MOVEMENT_LIST_H
+#define MOVEMENT_LIST_H
+
+#include <stdbool.h>
+
+#include "common.h"
+
+// Liste de mouvements stockée dans un tableau ; les mouvements restants vont de first à size
+struct movement_list_s {
+    movement_t* items;
+    int size;
+    int capacity;
+    int first;
+};
+typedef struct movement_list_s movement_list_t;
+
+// Créer une liste de mouvements vide
+movement_list_t* ml_create(int capacity);
+
+// Ajouter un mouvement en fin de liste
+void ml_add(movement_list_t* ml, movement_t movement);
+
+// Récupérer le premier mouvement restant (NULL si la liste est vide)
+movement_t* ml_get(movement_list_t* ml);
+
+// Retirer le premier mouvement restant
+void ml_remove(movement_list_t* ml);
+
+// Nombre de mouvements restants
+int ml_remaining(movement_list_t* ml);
+
+// Vérifier s'il reste des mouvements
+bool ml_is_empty(movement_list_t* ml);
+
+// Inverser l'ordre des mouvements restants
+void ml_reverse(movement_list_t* ml);
+
+// Copier les mouvements restants
+movement_list_t* ml_copy(movement_list_t* ml);
+
+// Libérer la liste
+void ml_free(movement_list_t* ml);
+
+#endif // MOVEMENT_LIST_H
@@ -0,0 +1,83 @@
+#include <stdlib.h>
+
+#include "occupancy.h"
+#include "instrument.h"
+
+#define OCCUPANCY_EMPTY (~0ULL)
+
+// Clé d'un couple (case, créneau)
+unsigned long long occupancy_key(int cell, int bucket) {
+    return ((unsigned long long) (unsigned int) bucket << 32) | (unsigned int) cell;
+}
+
+// Position de départ d'une clé dans la table (mélange de Fibonacci)
+int occupancy_slot(unsigned long long key, int capacity) {
+    return (int) ((key * 11400714819323198485ULL) >> 32) & (capacity - 1);
+}
+
+// Allouer les tableaux d'une table vide
+void occupancy_alloc(occupancy_t* occupancy, int capacity) {
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (sizeof(unsigned long long) + sizeof(int)) * capacity);
+    occupancy->keys = (unsigned long long*) malloc(sizeof(unsigned long long) * capacity);
+    occupancy->counts = (int*) malloc(sizeof(int) * capacity);
+    for (int k = 0; k < capacity; k++) occupancy->keys[k] = OCCUPANCY_EMPTY;
+    occupancy->capacity = capacity;
+    occupancy->size = 0;
+}
+
+// Créer une table d'occupation vide
+occupancy_t* occupancy_create(int capacity) {
+    int rounded = 16;
+    while (rounded < capacity) rounded *= 2;
+    occupancy_t* occupancy = (occupancy_t*) malloc(sizeof(occupancy_t));
+    occupancy_alloc(occupancy, rounded);
+    return occupancy;
+}
+
+// Nombre d'agents présents dans une case pendant un créneau
+int occupancy_get(const occupancy_t* occupancy, int cell, int bucket) {
+    unsigned long long key = occupancy_key(cell, bucket);
+    int mask = occupancy->capacity - 1;
+    for (int k = occupancy_slot(key, occupancy->capacity); ; k = (k + 1) & mask) {
+        if (occupancy->keys[k] == key) return occupancy->counts[k];
+        if (occupancy->keys[k] == OCCUPANCY_EMPTY) return 0;
+    }
+}
+
+// Ajouter un agent dans une case pendant un créneau
+void occupancy_add(occupancy_t* occupancy, int cell, int bucket) {
+    // La table est doublée lorsqu'elle est à moitié pleine
+    if (2 * (occupancy->size + 1) > occupancy->capacity) {
+        occupancy_t old = *occupancy;
+        occupancy_alloc(occupancy, 2 * old.capacity);
+        for (int k = 0; k < old.capacity; k++) {
+            if (old.keys[k] == OCCUPANCY_EMPTY) continue;
+            int slot = occupancy_slot(old.keys[k], occupancy->capacity);
+            while (occupancy->keys[slot] != OCCUPANCY_EMPTY) slot = (slot + 1) & (occupancy->capacity - 1);
+            occupancy->keys[slot] = old.keys[k];
+            occupancy->counts[slot] = old.counts[k];
+        }
+        occupancy->size = old.size;
+        free(old.keys);
+        free(old.counts);
+    }
+
+    unsigned long long key = occupancy_key(cell, bucket);
+    int mask = occupancy->capacity - 1;
+    int k = occupancy_slot(key, occupancy->capacity);
+    while (occupancy->keys[k] != key && occupancy->keys[k] != OCCUPANCY_EMPTY) k = (k + 1) & mask;
+    if (occupancy->keys[k] == OCCUPANCY_EMPTY) {
+        occupancy->keys[k] = key;
+        occupancy->counts[k] = 0;
+        occupancy->size++;
+    }
+    occupancy->counts[k]++;
+}
+
+// Libérer une table d'occupation
+void occupancy_free(occupancy_t* occupancy) {
+    free(occupancy->keys);
+    free(occupancy->counts);
+    free(occupancy);
+}
@@ -0,0 +1,26 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+// Occupation des cases par créneau de temps, stockée dans une table de hachage (adressage ouvert) :
+// seuls les couples (case, créneau) effectivement traversés occupent de la mémoire
+struct occupancy_s {
+    unsigned long long* keys;   // Créneau dans les 32 bits de poids fort, case dans ceux de poids faible
+    int* counts;
+    int capacity;               // Puissance de deux
+    int size;                   // Couples (case, créneau) occupés
+};
+typedef struct occupancy_s occupancy_t;
+
+// Créer une table d'occupation vide
+occupancy_t* occupancy_create(int capacity);
+
+// Nombre d'agents présents dans une case pendant un créneau
+int occupancy_get(const occupancy_t* occupancy, int cell, int bucket);
+
+// Ajouter un agent dans une case pendant un créneau
+void occupancy_add(occupancy_t* occupancy, int cell, int bucket);
+
+// Libérer une table d'occupation
+void occupancy_free(occupancy_t* occupancy);
+
+#endif // OCCUPANCY_H
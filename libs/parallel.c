@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+int PARALLEL_THREADS = 0; // Par défaut, un fil par coeur
+
+// Tranche de travail d'un fil d'exécution
+struct parallel_task_s {
+    int start;
+    int end;
+    void (*fn)(int start, int end, void* data);
+    void* data;
+};
+typedef struct parallel_task_s parallel_task_t;
+
+// Point d'entrée d'un fil d'exécution
+void* parallel_run(void* arg) {
+    parallel_task_t* task = (parallel_task_t*) arg;
+    task->fn(task->start, task->end, task->data);
+    return NULL;
+}
+
+// Nombre effectif de fils d'exécution
+int parallel_threads() {
+    if (PARALLEL_THREADS > 0) return PARALLEL_THREADS;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int) cores : 1;
+}
+
+// Exécuter fn sur l'intervalle [0, n) découpé en tranches contiguës, une par fil d'exécution
+void parallel_for(int n, void (*fn)(int start, int end, void* data), void* data) {
+    int threads = parallel_threads();
+    if (threads > n) threads = n;
+    if (threads <= 1) {
+        if (n > 0) fn(0, n, data);
+        return;
+    }
+
+    pthread_t* ids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    parallel_task_t* tasks = (parallel_task_t*) malloc(sizeof(parallel_task_t) * threads);
+    for (int t = 0; t < threads; t++) {
+        tasks[t] = (parallel_task_t) {
+            .start = (int) ((long) n * t / threads),
+            .end = (int) ((long) n * (t + 1) / threads),
+            .fn = fn,
+            .data = data
+        };
+    }
+    // Le fil principal traite la première tranche
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&ids[t], NULL, parallel_run, &tasks[t]);
+    }
+    parallel_run(&tasks[0]);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    free(ids);
+    free(tasks);
+}
@@ -0,0 +1,14 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+
+// Nombre de fils d'exécution à utiliser (0 = nombre de coeurs disponibles)
+extern int PARALLEL_THREADS;
+
+// Nombre effectif de fils d'exécution
+int parallel_threads();
+
+// Exécuter fn sur l'intervalle [0, n) découpé en tranches contiguës, une par fil d'exécution
+void parallel_for(int n, void (*fn)(int start, int end, void* data), void* data);
+
+#endif
@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "path_cache.h"
+#include "heuristic.h"
+#include "crowd.h"
+#include "instrument.h"
+#include "cost.h"
+#include "common.h"
+
+int PATH_CACHE = 0; // Une recherche par agent par défaut
+int PATH_CACHE_TOLERANCE = 0;
+
+// Distances depuis la zone de départ du mouvement en cours sur ce fil (agrandies au besoin)
+thread_local double** path_cache_field = NULL;
+thread_local int path_cache_rows = 0;
+thread_local int path_cache_cols = 0;
+
+// Créer un cache vide
+path_cache_t path_cache_create() {
+    return (path_cache_t) {.cells = NULL, .suffix = NULL, .length = 0, .capacity = 0, .field_ready = false,
+                           .hits = 0, .misses = 0};
+}
+
+// Libérer un cache
+void path_cache_free(path_cache_t* cache) {
+    free(cache->cells);
+    free(cache->suffix);
+    *cache = path_cache_create();
+}
+
+// Garder le chemin qui vient d'être appliqué (de l'arrivée au départ), s'il relie bien les deux zones
+void path_cache_store(path_cache_t* cache, const position_t* path, int length, movement_t movement) {
+    cache->length = 0;
+    if (length < 1 || !region_contains(movement.target, movement.target_span, path[0].i, path[0].j)) return;
+    // Seule la dernière case est dans la zone de départ, et les cases se suivent
+    for (int k = 0; k < length; k++) {
+        bool in_start = region_contains(movement.start, movement.start_span, path[k].i, path[k].j);
+        if (in_start != (k == length - 1)) return;
+        if (k > 0) {
+            int di = abs(path[k].i - path[k - 1].i);
+            int dj = abs(path[k].j - path[k - 1].j);
+            if (di > 1 || dj > 1 || di + dj == 0) return;
+        }
+    }
+    if (length > cache->capacity) {
+        cache->capacity = (length > 2 * cache->capacity) ? length : 2 * cache->capacity;
+        cache->cells = (position_t*) realloc(cache->cells, sizeof(position_t) * cache->capacity);
+        cache->suffix = (double*) realloc(cache->suffix, sizeof(double) * cache->capacity);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+    }
+    memcpy(cache->cells, path, sizeof(position_t) * length);
+    cache->length = length;
+}
+
+// Calculer les distances depuis la zone de départ du mouvement
+void path_cache_compute_field(environment_t* env, cost_table_t* costs, movement_t movement) {
+    if (env->rows > path_cache_rows || env->cols > path_cache_cols) {
+        if (path_cache_field != NULL) free(path_cache_field[0]);
+        free(path_cache_field);
+        path_cache_field = (double**) malloc(sizeof(double*) * env->rows);
+        double* cells = (double*) malloc(sizeof(double) * env->rows * env->cols);
+        for (int i = 0; i < env->rows; i++) path_cache_field[i] = cells + (long long) i * env->cols;
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(double) * env->rows * env->cols);
+        path_cache_rows = env->rows;
+        path_cache_cols = env->cols;
+    }
+    else {
+        // Les lignes sont recalées sur la largeur de cet environnement
+        for (int i = 0; i < env->rows; i++) path_cache_field[i] = path_cache_field[0] + (long long) i * env->cols;
+    }
+    heuristic_sweep(env, costs, movement.start, movement.start_span, path_cache_field);
+}
+
+// Tester si le chemin gardé reste, à la tolérance près, un plus court chemin aux coûts actuels
+bool path_cache_check(path_cache_t* cache, environment_t* env, cost_table_t* costs, movement_t movement) {
+    if (cache->length == 0) return false;
+    if (!cache->field_ready) {
+        path_cache_compute_field(env, costs, movement);
+        cache->field_ready = true;
+    }
+    double** field = path_cache_field;
+    double scale = 1. + PATH_CACHE_TOLERANCE / 1000.;
+    position_t* cells = cache->cells;
+    double* suffix = cache->suffix;
+    int last = cache->length - 1;
+
+    // Coût de la fin du chemin après chaque case (les cases du chemin sont les seules à avoir changé)
+    suffix[0] = 0.;
+    for (int k = 1; k <= last; k++) {
+        position_t a = cells[k];
+        position_t b = cells[k - 1];
+        double step = (a.i != b.i && a.j != b.j) ? direction_lengths[4] : 1.;
+        suffix[k] = suffix[k - 1] + cost_get(costs, env->agents[b.i][b.j]) * step;
+    }
+    double cost = suffix[last];
+
+    // Chemins finissant sur une autre case de la zone d'arrivée
+    region_cells_t targets = region_cells(movement.target, movement.target_span, env->rows, env->cols);
+    position_t t;
+    bool valid = true;
+    while (valid && region_cells_next(&targets, env->agents, &t)) {
+        if (t.i == cells[0].i && t.j == cells[0].j) continue;
+        if (field[t.i][t.j] * scale < cost) valid = false;
+    }
+
+    // Chemins rejoignant le chemin gardé en cells[k] depuis une voisine qui n'est pas la case précédente
+    for (int k = 0; valid && k < last; k++) {
+        position_t v = cells[k];
+        position_t previous = cells[k + 1];
+        double entry = cost_get(costs, env->agents[v.i][v.j]);
+        for (int d = 0; d < CONNECTIVITY; d++) {
+            if (!env_can_move(env, v.i, v.j, d)) continue;
+            int ni = v.i + directions[d][0];
+            int nj = v.j + directions[d][1];
+            if (ni == previous.i && nj == previous.j) continue;
+            if ((field[ni][nj] + entry * direction_lengths[d] + suffix[k]) * scale < cost) {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    if (valid) cache->hits++;
+    else {
+        cache->length = 0;
+        cache->misses++;
+    }
+    return valid;
+}
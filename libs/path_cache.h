@@ -0,0 +1,46 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <stdbool.h>
+
+#include "crowd.h"
+#include "cost.h"
+#include "common.h"
+
+// 1 pour réutiliser le chemin de l'agent précédent d'un mouvement tant qu'il reste le plus court (0 par défaut)
+extern int PATH_CACHE;
+
+// Ecart relatif toléré, en millièmes, entre le chemin repris et le plus court chemin (0 par défaut)
+extern int PATH_CACHE_TOLERANCE;
+
+// Dernier chemin d'un mouvement. Entre deux agents d'un même mouvement, seules les cases de ce chemin
+// reçoivent un agent : ce sont les seules dont le coût change
+struct path_cache_s {
+    position_t* cells;      // De l'arrivée au départ, comme routing_state.path
+    double* suffix;         // Coût du chemin après chaque case, jusqu'à l'arrivée, aux coûts actuels
+    int length;             // 0 si aucun chemin n'est gardé
+    int capacity;
+    bool field_ready;       // Distances depuis le départ calculées pour ce mouvement
+    int hits;               // Agents routés sans recherche
+    int misses;             // Chemins gardés puis rejetés
+};
+typedef struct path_cache_s path_cache_t;
+
+// Créer un cache vide
+path_cache_t path_cache_create();
+
+// Libérer un cache
+void path_cache_free(path_cache_t* cache);
+
+// Garder le chemin qui vient d'être appliqué (de l'arrivée au départ), s'il relie bien les deux zones
+void path_cache_store(path_cache_t* cache, const position_t* path, int length, movement_t movement);
+
+// Tester si le chemin gardé coûte au plus PATH_CACHE_TOLERANCE millièmes de plus qu'un plus court chemin
+// aux coûts actuels. Tout autre chemin finit par une partie du chemin gardé (éventuellement vide), qu'il
+// rejoint depuis une case y hors du chemin : il coûte au moins la distance du départ à y, calculée au premier
+// test du mouvement, plus le coût de la fin du chemin gardé. Les coûts ne font qu'augmenter, donc cette
+// distance reste un minorant. Le test ne parcourt que le chemin et ses voisines. En cas de succès, suffix
+// donne les coûts de la fin du chemin
+bool path_cache_check(path_cache_t* cache, environment_t* env, cost_table_t* costs, movement_t movement);
+
+#endif
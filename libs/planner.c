@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "planner.h"
+#include "crowd.h"
+#include "movement_list.h"
+#include "logging.h"
+#include "common.h"
+#include "instrument.h"
+
+int PLANNER = 0;
+int PLANNER_ROUND = 0;
+
+// Mouvement et sa place dans la liste d'origine
+struct planner_entry_s {
+    movement_t movement;
+    int index;      // Première apparition du couple départ/cible
+    int group;      // Première apparition de la cible
+};
+typedef struct planner_entry_s planner_entry_t;
+
+// Comparer deux positions
+int planner_compare_positions(position_t a, position_t b) {
+    if (a.i != b.i) return a.i < b.i ? -1 : 1;
+    if (a.j != b.j) return a.j < b.j ? -1 : 1;
+    return 0;
+}
+
+// Comparer deux zones (coin puis étendue)
+int planner_compare_regions(position_t a, position_t a_span, position_t b, position_t b_span) {
+    int c = planner_compare_positions(a, b);
+    if (c == 0) c = planner_compare_positions(a_span, b_span);
+    return c;
+}
+
+// Comparer les zones d'arrivée de deux mouvements
+int planner_compare_targets(const movement_t* a, const movement_t* b) {
+    return planner_compare_regions(a->target, a->target_span, b->target, b->target_span);
+}
+
+// Comparer les zones de départ de deux mouvements
+int planner_compare_starts(const movement_t* a, const movement_t* b) {
+    return planner_compare_regions(a->start, a->start_span, b->start, b->start_span);
+}
+
+// Ordre cible, départ, instant de départ, apparition : les doublons et les mouvements de même cible sont voisins
+int planner_compare_pairs(const void* a, const void* b) {
+    const planner_entry_t* x = (const planner_entry_t*) a;
+    const planner_entry_t* y = (const planner_entry_t*) b;
+    int c = planner_compare_targets(&x->movement, &y->movement);
+    if (c == 0) c = planner_compare_starts(&x->movement, &y->movement);
+    if (c == 0) c = x->movement.departure - y->movement.departure;
+    if (c == 0) c = x->index - y->index;
+    return c;
+}
+
+// Ordre du plan : groupe, puis apparition dans le groupe
+int planner_compare_plan(const void* a, const void* b) {
+    const planner_entry_t* x = (const planner_entry_t*) a;
+    const planner_entry_t* y = (const planner_entry_t*) b;
+    if (x->group != y->group) return x->group - y->group;
+    return x->index - y->index;
+}
+
+// Fusionner les mouvements identiques (somme des agents) et regrouper les mouvements de même cible,
+// les groupes et les mouvements d'un groupe gardant l'ordre de leur première apparition
+void planner_plan(movement_list_t* movements) {
+    int count = ml_remaining(movements);
+    if (count == 0) return;
+    planner_entry_t* entries = (planner_entry_t*) malloc(sizeof(planner_entry_t) * count);
+    for (int k = 0; k < count; k++) {
+        entries[k] = (planner_entry_t) {.movement = movements->items[movements->first + k], .index = k, .group = k};
+    }
+    qsort(entries, count, sizeof(planner_entry_t), planner_compare_pairs);
+
+    // Fusion des doublons : le premier de chaque couple (le plus ancien) reçoit les agents des suivants
+    int merged = 0;
+    for (int k = 0; k < count; k++) {
+        if (merged > 0 && planner_compare_targets(&entries[merged - 1].movement, &entries[k].movement) == 0
+                && planner_compare_starts(&entries[merged - 1].movement, &entries[k].movement) == 0
+                && entries[merged - 1].movement.departure == entries[k].movement.departure) {
+            entries[merged - 1].movement.agents += entries[k].movement.agents;
+        }
+        else {
+            entries[merged++] = entries[k];
+        }
+    }
+
+    // Un groupe par cible, repéré par la première apparition de la cible
+    int groups = 0;
+    for (int a = 0, b; a < merged; a = b) {
+        int first = entries[a].index;
+        for (b = a + 1; b < merged && planner_compare_targets(&entries[a].movement, &entries[b].movement) == 0; b++) {
+            if (entries[b].index < first) first = entries[b].index;
+        }
+        for (int k = a; k < b; k++) entries[k].group = first;
+        groups++;
+    }
+    qsort(entries, merged, sizeof(planner_entry_t), planner_compare_plan);
+
+    movements->first = 0;
+    movements->size = merged;
+    for (int k = 0; k < merged; k++) movements->items[k] = entries[k].movement;
+    free(entries);
+    log_info("Planification : %d mouvements, %d après fusion, %d cibles", count, merged, groups);
+}
+
+// Router des mouvements planifiés : les mouvements d'un groupe avancent par tours de PLANNER_ROUND agents
+// et partagent l'heuristique de leur cible, recalculée tous les modulo agents du groupe
+void multiple_move_env_planned_a_star(movement_list_t* movements, environment_t* env,
+                                      int weight0, int alpha, int modulo) {
+    log_debug("Déplacement d'agents planifiés avec A* itératif");
+    INSTR_SCOPE(INSTR_STAGE_ROUTING);
+    int round = (PLANNER_ROUND > 0) ? PLANNER_ROUND : modulo;
+    long long refreshes = 0;
+    long long refreshes_per_movement = 0;
+
+    movement_t* items = movements->items;
+    for (int a = movements->first, b; a < movements->size; a = b) {
+        for (b = a + 1; b < movements->size && planner_compare_targets(&items[a], &items[b]) == 0; b++) {}
+
+        // Les itérations sont comptées sur tout le groupe : un recalcul de l'heuristique tous les modulo agents
+        int routed = 0;
+        bool remaining = true;
+        int* left = (int*) malloc(sizeof(int) * (b - a));
+        for (int k = a; k < b; k++) {
+            left[k - a] = items[k].agents;
+            refreshes_per_movement += (items[k].agents + modulo - 1) / modulo;
+        }
+        while (remaining) {
+            remaining = false;
+            for (int k = a; k < b; k++) {
+                int agents = (left[k - a] < round) ? left[k - a] : round;
+                if (agents <= 0) continue;
+                movement_t slice = items[k];
+                slice.agents = routed + agents;
+                move_env_iterative_a_star_shared(slice, env, weight0, alpha, modulo, routed);
+                refreshes += (routed + agents - 1) / modulo - (routed - 1 + modulo) / modulo + 1;
+                routed += agents;
+                left[k - a] -= agents;
+                remaining = remaining || left[k - a] > 0;
+            }
+        }
+        free(left);
+    }
+    // Les mouvements sont consommés, comme par multiple_move_env_iterative_a_star
+    movements->first = movements->size;
+    log_info("Routage planifié : %lld recalculs de l'heuristique (%lld sans regroupement)", refreshes,
+             refreshes_per_movement);
+    log_debug("Déplacement d'agents planifiés avec A* itératif terminé");
+}
@@ -0,0 +1,22 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "crowd.h"
+#include "movement_list.h"
+
+// Planification des mouvements avant le routage (0 = ordre du fichier, comme avant)
+extern int PLANNER;
+
+// Agents routés par mouvement à chaque tour (0 = modulo)
+extern int PLANNER_ROUND;
+
+// Fusionner les mouvements identiques (somme des agents) et regrouper les mouvements de même cible,
+// les groupes et les mouvements d'un groupe gardant l'ordre de leur première apparition
+void planner_plan(movement_list_t* movements);
+
+// Router des mouvements planifiés : les mouvements d'un groupe avancent par tours de PLANNER_ROUND agents
+// et partagent l'heuristique de leur cible, recalculée tous les modulo agents du groupe
+void multiple_move_env_planned_a_star(movement_list_t* movements, environment_t* env,
+                                      int weight0, int alpha, int modulo);
+
+#endif
@@ -3,12 +3,14 @@
 #include <stdio.h>
 
 #include "priority_queue.h"
-
+#include "instrument.h"
 
 // Créer une file de priorité
 priority_queue_t* pq_create(int capacity) {
     priority_queue_t* pq = (priority_queue_t*) malloc(sizeof(priority_queue_t));
     pq->nodes = (heap_node_t*) malloc(sizeof(heap_node_t) * capacity);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 2);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(heap_node_t) * capacity);
     pq->len = 0;
     pq->capacity = capacity;
     return pq;
@@ -57,11 +59,19 @@ void percolate_up(priority_queue_t* pq, int index) {
 
 // Ajouter un élément à la file de priorité
 void pq_push(priority_queue_t* pq, double priority, void* value) {
+    // Doubler la capacité lorsque la file est pleine
     if (pq->len == pq->capacity) {
-        printf("Erreur : capacité maximale atteinte dans la file de priorité.\n");
-        exit(-1);
+        pq->capacity = pq->capacity > 0 ? 2 * pq->capacity : 16;
+        pq->nodes = (heap_node_t*) realloc(pq->nodes, sizeof(heap_node_t) * pq->capacity);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+        INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(heap_node_t) * pq->capacity);
+        if (pq->nodes == NULL) {
+            printf("Erreur : mémoire insuffisante pour la file de priorité.\n");
+            exit(-1);
+        }
     }
 
+    INSTR_COUNT(INSTR_COUNTER_PUSHES, 1);
     pq->nodes[pq->len].priority = priority;
     pq->nodes[pq->len].value = value;
     pq->len++;
@@ -75,6 +85,7 @@ void* pq_pop(priority_queue_t* pq) {
         exit(-1);
     }
 
+    INSTR_COUNT(INSTR_COUNTER_POPS, 1);
     void* min_position = pq->nodes[0].value;
     pq->nodes[0] = pq->nodes[pq->len - 1];
     pq->len--;
@@ -83,6 +94,11 @@ void* pq_pop(priority_queue_t* pq) {
     return min_position;
 }
 
+// Vider la file de priorité
+void pq_clear(priority_queue_t* pq) {
+    pq->len = 0;
+}
+
 // Vérifier si la file de priorité est vide
 bool pq_is_empty(priority_queue_t* pq) {
     return pq->len == 0;
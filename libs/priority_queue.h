@@ -12,7 +12,7 @@ typedef struct heap_node_s {
 typedef struct priority_queue_s {
     heap_node_t* nodes; // Tableau de nœuds
     int len;            // Nombre d'éléments dans la file
-    int capacity;       // Capacité maximale de la file
+    int capacity;       // Capacité allouée (doublée lorsque la file est pleine)
 } priority_queue_t;
 
 // Fonctions pour manipuler la file de priorité
@@ -20,6 +20,7 @@ priority_queue_t* pq_create(int capacity); // Créer une file de priorité
 void pq_free(priority_queue_t* pq); // Libérer une file de priorité
 void pq_push(priority_queue_t* pq, double priority, void* value); // Ajouter un élément
 void* pq_pop(priority_queue_t* pq); // Extraire l'élément avec la plus petite priorité
+void pq_clear(priority_queue_t* pq); // Vider la file
 bool pq_is_empty(priority_queue_t* pq); // Vérifier si la file est vide
 
 #endif // PRIORITY_QUEUE_H
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "pyramid.h"
+#include "crowd.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "logging.h"
+#include "common.h"
+#include "instrument.h"
+#include "cost.h"
+
+int PYRAMID_LEVELS = 0; // Routage multi-résolution désactivé par défaut
+int PYRAMID_RADIUS = 2;
+
+// Allouer les tableaux de recherche d'un niveau
+void pyramid_level_alloc(pyramid_level_t* level) {
+    int size = level->env.rows * level->env.cols;
+    level->dis = (double*) malloc(sizeof(double) * size);
+    level->pred = (int*) malloc(sizeof(int) * size);
+    level->seen = (int*) calloc(size, sizeof(int));
+    level->closed = (int*) calloc(size, sizeof(int));
+    level->corridor = (int*) calloc(size, sizeof(int));
+    level->cells = (position_t*) malloc(sizeof(position_t) * size);
+    for (int i = 0; i < level->env.rows; i++) {
+        for (int j = 0; j < level->env.cols; j++) {
+            level->cells[i * level->env.cols + j] = (position_t) {.i = i, .j = j};
+        }
+    }
+}
+
+// Construire une pyramide au-dessus d'un environnement
+pyramid_t pyramid_create(environment_t* env, int levels) {
+    log_debug("Construction d'une pyramide de %d niveaux", levels);
+    if (levels < 1) levels = 1;
+
+    pyramid_t pyramid = {
+        .levels = levels,
+        .level = (pyramid_level_t*) malloc(sizeof(pyramid_level_t) * levels),
+        .epoch = 0,
+        .path = (int*) malloc(sizeof(int) * env->rows * env->cols),
+        .path_len = 0,
+        .expanded = 0
+    };
+
+    pyramid.level[0].env = *env;
+    pyramid.level[0].scale = 1;
+    pyramid_level_alloc(&pyramid.level[0]);
+
+    for (int k = 1; k < levels; k++) {
+        environment_t* fine = &pyramid.level[k - 1].env;
+        // On s'arrête avant que le niveau grossier ne se réduise à une seule cellule
+        if (fine->rows < 2 || fine->cols < 2) {
+            pyramid.levels = k;
+            break;
+        }
+        environment_t coarse = env_alloc((fine->rows + 1) / 2, (fine->cols + 1) / 2);
+        // Une cellule grossière est libre dès qu'un de ses pixels l'est (les couloirs étroits sont conservés)
+        // et porte la congestion maximale de ses pixels libres
+        for (int i = 0; i < coarse.rows; i++) {
+            for (int j = 0; j < coarse.cols; j++) {
+                int value = -1;
+                for (int x = 2 * i; x < 2 * i + 2 && x < fine->rows; x++) {
+                    for (int y = 2 * j; y < 2 * j + 2 && y < fine->cols; y++) {
+                        if (fine->agents[x][y] > value) value = fine->agents[x][y];
+                    }
+                }
+                coarse.agents[i][j] = value;
+            }
+        }
+        pyramid.level[k].env = coarse;
+        pyramid.level[k].scale = 2 * pyramid.level[k - 1].scale;
+        pyramid_level_alloc(&pyramid.level[k]);
+    }
+
+    log_debug("Pyramide construite : %d niveaux, le plus grossier de %d x %d", pyramid.levels,
+              pyramid.level[pyramid.levels - 1].env.rows, pyramid.level[pyramid.levels - 1].env.cols);
+    return pyramid;
+}
+
+// Libérer une pyramide (l'environnement d'origine est conservé)
+void pyramid_free(pyramid_t* pyramid) {
+    for (int k = 0; k < pyramid->levels; k++) {
+        pyramid_level_t* level = &pyramid->level[k];
+        if (k > 0) env_free(level->env);
+        free(level->dis);
+        free(level->pred);
+        free(level->seen);
+        free(level->closed);
+        free(level->corridor);
+        free(level->cells);
+    }
+    free(pyramid->level);
+    free(pyramid->path);
+}
+
+// Position d'un pixel du niveau 0 dans un niveau de la pyramide
+position_t pyramid_position(pyramid_t* pyramid, int k, position_t p) {
+    pyramid_level_t* level = &pyramid->level[k];
+    position_t q = {.i = p.i / level->scale, .j = p.j / level->scale};
+    if (q.i >= level->env.rows) q.i = level->env.rows - 1;
+    if (q.j >= level->env.cols) q.j = level->env.cols - 1;
+    return q;
+}
+
+// A* sur un niveau, limité aux cellules du couloir si corridor > 0 ; le chemin trouvé est gardé dans pyramid->path
+bool pyramid_search(pyramid_t* pyramid, priority_queue_t* pq, int k, position_t start, position_t target,
+                    int corridor, cost_table_t* costs) {
+    pyramid_level_t* level = &pyramid->level[k];
+    environment_t* env = &level->env;
+    int epoch = ++pyramid->epoch;
+    int s = start.i * env->cols + start.j;
+    int t = target.i * env->cols + target.j;
+
+    level->dis[s] = 0.;
+    level->seen[s] = epoch;
+    pq_clear(pq);
+    pq_push(pq, costs->lower * grid_distance(start.i - target.i, start.j - target.j), (void*) &level->cells[s]);
+
+    bool found = false;
+    while (!pq_is_empty(pq)) {
+        position_t* u = (position_t*) pq_pop(pq);
+        int ui = u->i * env->cols + u->j;
+        if (level->closed[ui] == epoch) continue;
+        level->closed[ui] = epoch;
+        pyramid->expanded++;
+        INSTR_COUNT(INSTR_COUNTER_EXPANDED, 1);
+        if (ui == t) {
+            found = true;
+            break;
+        }
+
+        for (int d = 0; d < CONNECTIVITY; d++) {
+            if (!env_can_move(env, u->i, u->j, d)) continue;
+            int ni = u->i + directions[d][0];
+            int nj = u->j + directions[d][1];
+            int n = ni * env->cols + nj;
+            if (level->closed[n] == epoch) continue;
+            if (corridor > 0 && level->corridor[n] != corridor) continue;
+
+            double new_dist = level->dis[ui] + cost_get(costs, env->agents[ni][nj]) * direction_lengths[d];
+            if (level->seen[n] != epoch || new_dist < level->dis[n]) {
+                level->seen[n] = epoch;
+                level->dis[n] = new_dist;
+                level->pred[n] = ui;
+                // Chaque pas coûte au moins le plus petit coût d'une case fois sa longueur : la distance de la
+                // grille reste minorante
+                double h = costs->lower * grid_distance(ni - target.i, nj - target.j);
+                pq_push(pq, new_dist + h, (void*) &level->cells[n]);
+            }
+        }
+    }
+    if (!found) return false;
+
+    // Chemin de la cible vers le départ
+    pyramid->path_len = 0;
+    for (int c = t; c != s; c = level->pred[c]) {
+        pyramid->path[pyramid->path_len++] = c;
+    }
+    pyramid->path[pyramid->path_len++] = s;
+    return true;
+}
+
+// Marquer au niveau k le couloir autour du chemin trouvé au niveau k+1
+void pyramid_mark_corridor(pyramid_t* pyramid, int k, int radius, int corridor) {
+    environment_t* fine = &pyramid->level[k].env;
+    environment_t* coarse = &pyramid->level[k + 1].env;
+    int* marks = pyramid->level[k].corridor;
+
+    for (int p = 0; p < pyramid->path_len; p++) {
+        int ci = pyramid->path[p] / coarse->cols;
+        int cj = pyramid->path[p] % coarse->cols;
+        for (int di = -radius; di <= radius; di++) {
+            for (int dj = -radius; dj <= radius; dj++) {
+                int i = ci + di;
+                int j = cj + dj;
+                if (i < 0 || i >= coarse->rows || j < 0 || j >= coarse->cols) continue;
+                for (int x = 2 * i; x < 2 * i + 2 && x < fine->rows; x++) {
+                    for (int y = 2 * j; y < 2 * j + 2 && y < fine->cols; y++) {
+                        marks[x * fine->cols + y] = corridor;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Ajouter un agent sur le chemin trouvé au niveau 0 et remonter la congestion dans la pyramide
+void pyramid_apply_path(pyramid_t* pyramid, environment_t* env) {
+    INSTR_COUNT(INSTR_COUNTER_PATHS, 1);
+    INSTR_COUNT(INSTR_COUNTER_PATH_CELLS, pyramid->path_len);
+    for (int p = 0; p < pyramid->path_len; p++) {
+        int i = pyramid->path[p] / env->cols;
+        int j = pyramid->path[p] % env->cols;
+        int value = ++env->agents[i][j];
+        if (value > env->max) env->max = value;
+
+        for (int k = 1; k < pyramid->levels; k++) {
+            environment_t* coarse = &pyramid->level[k].env;
+            int* cell = &coarse->agents[i >> k][j >> k];
+            if (*cell >= value) break;
+            *cell = value;
+            if (value > coarse->max) coarse->max = value;
+        }
+    }
+}
+
+// Router un agent du niveau le plus grossier vers la pleine résolution
+bool pyramid_route(pyramid_t* pyramid, priority_queue_t* pq, position_t start, position_t target,
+                   cost_table_t* costs) {
+    int top = pyramid->levels - 1;
+    bool found = pyramid_search(pyramid, pq, top, pyramid_position(pyramid, top, start),
+                                pyramid_position(pyramid, top, target), 0, costs);
+
+    for (int k = top - 1; k >= 0 && found; k--) {
+        position_t s = pyramid_position(pyramid, k, start);
+        position_t t = pyramid_position(pyramid, k, target);
+
+        // Le couloir est élargi si le niveau grossier, optimiste, a laissé passer un mur
+        bool refined = false;
+        for (int attempt = 0, radius = PYRAMID_RADIUS; attempt < 3 && !refined; attempt++, radius = 2 * radius + 1) {
+            int corridor = ++pyramid->epoch;
+            pyramid_mark_corridor(pyramid, k, radius, corridor);
+            refined = pyramid_search(pyramid, pq, k, s, t, corridor, costs);
+        }
+        if (!refined) found = pyramid_search(pyramid, pq, k, s, t, 0, costs);
+    }
+
+    // Dernier recours : recherche sur la pleine résolution sans couloir
+    if (!found) found = pyramid_search(pyramid, pq, 0, start, target, 0, costs);
+    return found;
+}
+
+// Déplacer les agents d'un mouvement, du niveau grossier vers la pleine résolution
+void pyramid_move(pyramid_t* pyramid, movement_t movement, int weight0, int alpha) {
+    log_debug("Déplacement de %d agents avec le routage multi-résolution", movement.agents);
+    INSTR_SCOPE(INSTR_STAGE_MOVEMENT);
+    environment_t* env = &pyramid->level[0].env;
+    priority_queue_t* pq = pq_create(1024);
+    cost_table_t costs = cost_table_create(weight0, alpha);
+
+    // Les zones sont ramenées à leur centre
+    position_t start = {.i = movement.start.i + movement.start_span.i / 2,
+                        .j = movement.start.j + movement.start_span.j / 2};
+    position_t target = {.i = movement.target.i + movement.target_span.i / 2,
+                         .j = movement.target.j + movement.target_span.j / 2};
+    for (int a = 0; a < movement.agents; a++) {
+        if (!pyramid_route(pyramid, pq, start, target, &costs)) {
+            log_warning("Aucun chemin de (%d, %d) vers (%d, %d)", start.i, start.j, target.i, target.j);
+            break;
+        }
+        pyramid_apply_path(pyramid, env);
+    }
+
+    pq_free(pq);
+    cost_table_free(&costs);
+    log_debug("Déplacement des %d agents avec le routage multi-résolution terminé", movement.agents);
+}
+
+// Appliquer plusieurs mouvements à un environnement avec le routage multi-résolution
+void multiple_move_env_pyramid_a_star(movement_list_t* movements, environment_t* env,
+                                      int weight0, int alpha, int levels) {
+    log_debug("Déplacement d'agents avec le routage multi-résolution sur %d niveaux", levels);
+    INSTR_SCOPE(INSTR_STAGE_ROUTING);
+    pyramid_t pyramid = pyramid_create(env, levels);
+
+    while (!ml_is_empty(movements)) {
+        movement_t* m = ml_get(movements);
+        pyramid_move(&pyramid, *m, weight0, alpha);
+        ml_remove(movements);
+    }
+    // Le maximum est tenu à jour sur la copie du niveau 0
+    env->max = pyramid.level[0].env.max;
+
+    log_info("Routage multi-résolution : %lld cellules développées", pyramid.expanded);
+    pyramid_free(&pyramid);
+    log_debug("Déplacement d'agents avec le routage multi-résolution terminé");
+}
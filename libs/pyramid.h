@@ -0,0 +1,51 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "crowd.h"
+#include "movement_list.h"
+#include "common.h"
+
+// Nombre de niveaux de la pyramide (0 ou 1 = routage classique sur la pleine résolution)
+extern int PYRAMID_LEVELS;
+
+// Rayon du couloir autour du chemin grossier (en cellules du niveau grossier)
+extern int PYRAMID_RADIUS;
+
+// Un niveau de la pyramide et ses tableaux de recherche
+struct pyramid_level_s {
+    environment_t env;    // Au niveau 0, l'environnement d'origine (partagé)
+    int scale;            // Côté d'une cellule en pixels du niveau 0
+    double* dis;
+    int* pred;            // Indice de la cellule précédente
+    int* seen;            // Dernière recherche ayant atteint la cellule
+    int* closed;          // Dernière recherche ayant développé la cellule
+    int* corridor;        // Dernier couloir contenant la cellule
+    position_t* cells;    // Positions (valeurs de la file de priorité)
+};
+typedef struct pyramid_level_s pyramid_level_t;
+
+// Pyramide d'environnements, de la pleine résolution (niveau 0) au plus grossier
+struct pyramid_s {
+    int levels;
+    pyramid_level_t* level;
+    int epoch;              // Numéro de la recherche ou du couloir courant
+    int* path;              // Dernier chemin trouvé (indices, de la cible au départ)
+    int path_len;
+    long long expanded;     // Nombre total de cellules développées
+};
+typedef struct pyramid_s pyramid_t;
+
+// Construire une pyramide au-dessus d'un environnement
+pyramid_t pyramid_create(environment_t* env, int levels);
+
+// Libérer une pyramide (l'environnement d'origine est conservé)
+void pyramid_free(pyramid_t* pyramid);
+
+// Déplacer les agents d'un mouvement, du niveau grossier vers la pleine résolution
+void pyramid_move(pyramid_t* pyramid, movement_t movement, int weight0, int alpha);
+
+// Appliquer plusieurs mouvements à un environnement avec le routage multi-résolution
+void multiple_move_env_pyramid_a_star(movement_list_t* movements, environment_t* env,
+                                      int weight0, int alpha, int levels);
+
+#endif
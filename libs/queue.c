@@ -1,79 +1,77 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "queue.h"
+#include "instrument.h"
 
 
-struct maillon_s {
-    void* value;
-    struct maillon_s* next;
-};
-typedef struct maillon_s maillon_t;
+#define QUEUE_INITIAL_CAPACITY 64
 
+// File circulaire : les éléments, rangés par valeur, vont de head à head + len (modulo capacity)
 struct queue_s {
-    maillon_t* head;
-    maillon_t* tail;
+    char* values;
+    int size;
+    int capacity;
+    int head;
     int len;
 };
 typedef struct queue_s queue_t;
 
-// Créer un maillon
-maillon_t* maillon_create(void* value) {
-    maillon_t* m = (maillon_t*) malloc(sizeof(maillon_t));
-    m->value = value;
-    m->next = NULL;
-    return m;
-}
-
-// Initialiser une queue
-queue_t* queue_create() {
+// Initialiser une queue d'éléments de size octets
+queue_t* queue_create(int size) {
     queue_t* q = (queue_t*) malloc(sizeof(queue_t));
-    q->head = NULL;
-    q->tail = NULL;
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) size * QUEUE_INITIAL_CAPACITY);
+    q->values = (char*) malloc((size_t) size * QUEUE_INITIAL_CAPACITY);
+    q->size = size;
+    q->capacity = QUEUE_INITIAL_CAPACITY;
+    q->head = 0;
     q->len = 0;
     return q;
 }
 
-// Ajouter un élément à la queue (enqueue)
-void queue_enqueue(queue_t* q, void* value) {
-    maillon_t* new_maillon = maillon_create(value);
-    if (q->tail == NULL) {
-        q->head = new_maillon;
-        q->tail = new_maillon;
-    } else {
-        q->tail->next = new_maillon;
-        q->tail = new_maillon;
+// Doubler la capacité de la queue ; les éléments qui faisaient le tour passent après les autres
+void queue_grow(queue_t* q) {
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 1);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) q->size * 2 * q->capacity);
+    q->values = (char*) realloc(q->values, (size_t) q->size * 2 * q->capacity);
+    if (q->values == NULL) {
+        fprintf(stderr, "Erreur : mémoire insuffisante pour la queue.\n");
+        exit(-1);
     }
+    int wrapped = q->head + q->len - q->capacity;
+    if (wrapped > 0) memcpy(q->values + (size_t) q->size * q->capacity, q->values, (size_t) q->size * wrapped);
+    q->capacity *= 2;
+}
+
+// Ajouter un élément à la queue (enqueue)
+void queue_enqueue(queue_t* q, const void* value) {
+    if (q->len == q->capacity) queue_grow(q);
+    memcpy(q->values + (size_t) q->size * ((q->head + q->len) % q->capacity), value, q->size);
     q->len++;
 }
 
 // Retirer un élément de la queue (dequeue)
 void* queue_dequeue(queue_t* q) {
-    if (q->head == NULL) {
+    if (q->len == 0) {
         fprintf(stderr, "Erreur : la queue est vide.\n");
         exit(-1);
     }
-    maillon_t* temp = q->head;
-    void* value = temp->value;
-    q->head = q->head->next;
-    if (q->head == NULL) {
-        q->tail = NULL;
-    }
+    void* value = q->values + (size_t) q->size * q->head;
+    q->head = (q->head + 1) % q->capacity;
     q->len--;
-    free(temp);
     return value;
 }
 
 // Vérifier si la queue est vide
 bool queue_is_empty(queue_t* q) {
-    return q->head == NULL;
+    return q->len == 0;
 }
 
 // Libérer une queue
 void queue_free(queue_t* q) {
-    while (!queue_is_empty(q)) {
-        queue_dequeue(q);
-    }
+    free(q->values);
     free(q);
-}
\ No newline at end of file
+}
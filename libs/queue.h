@@ -6,10 +6,10 @@
 // Définition des structures
 typedef struct queue_s queue_t;
 
-// Fonctions pour manipuler la queue
-queue_t* queue_create(); // Créer une nouvelle queue
-void queue_enqueue(queue_t* q, void* value); // Ajouter un élément à la queue
-void* queue_dequeue(queue_t* q); // Retirer un élément de la queue
+// Fonctions pour manipuler la queue (les éléments de size octets y sont recopiés)
+queue_t* queue_create(int size); // Créer une nouvelle queue
+void queue_enqueue(queue_t* q, const void* value); // Ajouter une copie de *value à la queue
+void* queue_dequeue(queue_t* q); // Retirer un élément de la queue (valable jusqu'au prochain ajout)
 bool queue_is_empty(queue_t* q); // Vérifier si la queue est vide
 void queue_free(queue_t* q); // Libérer la mémoire de la queue
 
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <opencv2/opencv.hpp>
+
+#include "render.h"
+#include "image.h"
+#include "crowd.h"
+#include "parallel.h"
+#include "logging.h"
+#include "instrument.h"
+
+// Rendu d'une tranche de lignes : la couleur de chaque valeur de congestion est lue dans une table
+struct render_task_s {
+    environment_t env;
+    int n;
+    const unsigned char* lut;   // channels octets par valeur de congestion, de 0 à env.max
+    int first;                  // Plus petite congestion colorée (les autres cases gardent l'image)
+    colored_image_t colored;
+    image_t grey;
+    cv::Mat* mat;
+};
+typedef struct render_task_s render_task_t;
+
+// Lignes [start, end) d'une image colorée
+void render_colored_rows(int start, int end, void* data) {
+    render_task_t* task = (render_task_t*) data;
+    int cols = task->mat->cols;
+    for (int y = start; y < end; y++) {
+        unsigned char* out = task->mat->ptr<unsigned char>(y);
+        const colored_pixel_t* in = task->colored.pixels[y];
+        int i = y / task->n;
+        const int* row = (i < task->env.rows) ? task->env.agents[i] : NULL;
+
+        // Chaque case couvre n pixels consécutifs de la ligne
+        int x = 0;
+        for (int j = 0; row != NULL && j < task->env.cols && x < cols; j++) {
+            int last = (x + task->n < cols) ? x + task->n : cols;
+            if (row[j] >= task->first) {
+                const unsigned char* color = task->lut + 3 * row[j];
+                for (; x < last; x++) {
+                    out[3 * x] = color[0];
+                    out[3 * x + 1] = color[1];
+                    out[3 * x + 2] = color[2];
+                }
+            }
+            else {
+                for (; x < last; x++) {
+                    out[3 * x] = (unsigned char) in[x].b;
+                    out[3 * x + 1] = (unsigned char) in[x].g;
+                    out[3 * x + 2] = (unsigned char) in[x].r;
+                }
+            }
+        }
+        for (; x < cols; x++) {
+            out[3 * x] = (unsigned char) in[x].b;
+            out[3 * x + 1] = (unsigned char) in[x].g;
+            out[3 * x + 2] = (unsigned char) in[x].r;
+        }
+    }
+}
+
+// Lignes [start, end) d'une image en niveaux de gris
+void render_grey_rows(int start, int end, void* data) {
+    render_task_t* task = (render_task_t*) data;
+    int cols = task->mat->cols;
+    for (int y = start; y < end; y++) {
+        unsigned char* out = task->mat->ptr<unsigned char>(y);
+        const pixel_t* in = task->grey.pixels[y];
+        int i = y / task->n;
+        const int* row = (i < task->env.rows) ? task->env.agents[i] : NULL;
+
+        int x = 0;
+        for (int j = 0; row != NULL && j < task->env.cols && x < cols; j++) {
+            int last = (x + task->n < cols) ? x + task->n : cols;
+            if (row[j] >= task->first) {
+                unsigned char value = task->lut[row[j]];
+                for (; x < last; x++) out[x] = value;
+            }
+            else {
+                for (; x < last; x++) out[x] = (unsigned char) (in[x] * 255.0);
+            }
+        }
+        for (; x < cols; x++) out[x] = (unsigned char) (in[x] * 255.0);
+    }
+}
+
+// Image 8 bits de la congestion sur une image colorée : chaque case de l'environnement couvre n x n pixels,
+// les cases empruntées en rouge (d'autant plus sombre que la congestion est forte), les autres laissées telles quelles
+cv::Mat render_colored(colored_image_t image, environment_t env, int n) {
+    log_debug("Rendu de la congestion sur l'image colorée : %s", image.name);
+    INSTR_SCOPE(INSTR_STAGE_RENDER);
+    cv::Mat mat(image.rows, image.cols, CV_8UC3);
+    if (mat.empty()) log_fatal("Erreur lors du rendu : cv::Mat vide");
+
+    // Sans congestion, l'image est recopiée telle quelle (BGR)
+    int max = (env.max > 0) ? env.max : 0;
+    unsigned char* lut = (unsigned char*) malloc(3 * (max + 1));
+    for (int c = 0; c <= max; c++) {
+        double alpha = (max > 0) ? 1. - (double) c / (double) max : 0.;
+        lut[3 * c] = 0;
+        lut[3 * c + 1] = 0;
+        lut[3 * c + 2] = (unsigned char) (255. * alpha * alpha * alpha);
+    }
+    render_task_t task = {
+        .env = env,
+        .n = (n > 0) ? n : 1,
+        .lut = lut,
+        .first = 1,
+        .colored = image,
+        .grey = {},
+        .mat = &mat
+    };
+    parallel_for(image.rows, render_colored_rows, &task);
+    free(lut);
+    log_debug("Rendu terminé : %s", image.name);
+    return mat;
+}
+
+// Image 8 bits de la congestion sur une image en niveaux de gris (congestion relative, murs laissés tels quels)
+cv::Mat render_grey(image_t image, environment_t env, int n) {
+    log_debug("Rendu de la congestion sur l'image : %s", image.name);
+    INSTR_SCOPE(INSTR_STAGE_RENDER);
+    cv::Mat mat(image.rows, image.cols, CV_8UC1);
+    if (mat.empty()) log_fatal("Erreur lors du rendu : cv::Mat vide");
+
+    int max = (env.max > 0) ? env.max : 0;
+    unsigned char* lut = (unsigned char*) malloc(max + 1);
+    for (int c = 0; c <= max; c++) {
+        lut[c] = (max > 0) ? (unsigned char) ((double) c / (double) max * 255.0) : 0;
+    }
+    render_task_t task = {
+        .env = env,
+        .n = (n > 0) ? n : 1,
+        .lut = lut,
+        .first = (env.max > 0) ? 0 : max + 1,
+        .colored = {},
+        .grey = image,
+        .mat = &mat
+    };
+    parallel_for(image.rows, render_grey_rows, &task);
+    free(lut);
+    log_debug("Rendu terminé : %s", image.name);
+    return mat;
+}
+
+// Ecrire la congestion sur une image colorée
+void render_colored_write(colored_image_t image, environment_t env, int n, const char* path) {
+    cv::Mat mat = render_colored(image, env, n);
+    cv::imwrite(path, mat);
+    log_debug("Image colorée écrite : %s dans %s", image.name, path);
+}
+
+// Ecrire la congestion sur une image en niveaux de gris
+void render_grey_write(image_t image, environment_t env, int n, const char* path) {
+    cv::Mat mat = render_grey(image, env, n);
+    cv::imwrite(path, mat);
+    log_debug("Image écrite : %s dans %s", image.name, path);
+}
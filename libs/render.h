@@ -0,0 +1,22 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <opencv2/opencv.hpp>
+
+#include "image.h"
+#include "crowd.h"
+
+// Image 8 bits de la congestion sur une image colorée : chaque case de l'environnement couvre n x n pixels,
+// les cases empruntées en rouge (d'autant plus sombre que la congestion est forte), les autres laissées telles quelles
+cv::Mat render_colored(colored_image_t image, environment_t env, int n);
+
+// Image 8 bits de la congestion sur une image en niveaux de gris (congestion relative, murs laissés tels quels)
+cv::Mat render_grey(image_t image, environment_t env, int n);
+
+// Ecrire la congestion sur une image colorée
+void render_colored_write(colored_image_t image, environment_t env, int n, const char* path);
+
+// Ecrire la congestion sur une image en niveaux de gris
+void render_grey_write(image_t image, environment_t env, int n, const char* path);
+
+#endif
@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "resample.h"
+#include "image.h"
+#include "parallel.h"
+#include "logging.h"
+#include "instrument.h"
+
+// Intervalle de pixels sources couvert par un pixel réduit
+struct resample_span_s {
+    int first;           // Premier pixel source (couvert partiellement)
+    int last;            // Dernier pixel source (inclus)
+    double first_weight; // Fraction couverte du premier pixel
+    double last_weight;  // Fraction couverte du dernier pixel
+};
+typedef struct resample_span_s resample_span_t;
+
+// Travail partagé par les fils d'exécution
+struct resample_s {
+    int rows;                    // Dimensions de l'image source
+    int cols;
+    int new_rows;                // Dimensions de l'image réduite
+    int new_cols;
+    int in_channels;             // 1 (niveaux de gris) ou 3 (r, g, b)
+    int out_channels;
+    bool to_grey;                // Conversion en niveaux de gris pendant la passe horizontale
+    double factor;
+    double** source;             // Lignes sources, in_channels valeurs par pixel
+    double** target;             // Lignes réduites, out_channels valeurs par pixel
+    double* temp;                // Passe horizontale (rows x new_cols x out_channels)
+    resample_span_t* col_spans;
+    resample_span_t* row_spans;
+};
+typedef struct resample_s resample_t;
+
+// Calculer les intervalles sources couverts par chaque pixel réduit (dans [0, limit))
+resample_span_t* resample_spans(int count, double factor, int limit) {
+    resample_span_t* spans = (resample_span_t*) malloc(sizeof(resample_span_t) * count);
+    for (int k = 0; k < count; k++) {
+        double x0 = k * factor;
+        double x1 = (k + 1) * factor;
+        int first = (int) floor(x0);
+        int last = (int) ceil(x1) - 1;
+        // Les erreurs d'arrondi ne doivent pas faire sortir de l'image
+        if (x1 > limit) x1 = limit;
+        if (last >= limit) last = limit - 1;
+        spans[k] = (resample_span_t) {
+            .first = first,
+            .last = last,
+            .first_weight = (first + 1 < x1 ? first + 1 : x1) - x0,
+            .last_weight = x1 - (last > x0 ? last : x0)
+        };
+    }
+    return spans;
+}
+
+// Passe horizontale sur les lignes sources [start, end)
+void resample_horizontal(int start, int end, void* data) {
+    resample_t* r = (resample_t*) data;
+    for (int i = start; i < end; i++) {
+        double* source = r->source[i];
+        double* out = r->temp + (size_t) i * r->new_cols * r->out_channels;
+
+        for (int j = 0; j < r->new_cols; j++) {
+            resample_span_t span = r->col_spans[j];
+            double sum[3] = {0., 0., 0.};
+            for (int k = span.first; k <= span.last; k++) {
+                double w = (k == span.first) ? span.first_weight : (k == span.last) ? span.last_weight : 1.;
+                for (int c = 0; c < r->in_channels; c++) {
+                    sum[c] += w * source[k * r->in_channels + c];
+                }
+            }
+            if (r->to_grey) {
+                // Pondérations standard (comme image_from_colored_image), la moyenne étant linéaire
+                out[j] = (0.299 * sum[0] + 0.587 * sum[1] + 0.114 * sum[2]) / 255.0;
+            }
+            else {
+                for (int c = 0; c < r->out_channels; c++) {
+                    out[j * r->out_channels + c] = sum[c];
+                }
+            }
+        }
+    }
+}
+
+// Passe verticale sur les lignes réduites [start, end)
+void resample_vertical(int start, int end, void* data) {
+    resample_t* r = (resample_t*) data;
+    int width = r->new_cols * r->out_channels;
+    double area = r->factor * r->factor;
+
+    for (int i = start; i < end; i++) {
+        resample_span_t span = r->row_spans[i];
+        double* out = r->target[i];
+        for (int j = 0; j < width; j++) out[j] = 0.;
+
+        for (int k = span.first; k <= span.last; k++) {
+            double w = (k == span.first) ? span.first_weight : (k == span.last) ? span.last_weight : 1.;
+            double* row = r->temp + (size_t) k * width;
+            // Boucle contiguë, vectorisée par le compilateur
+            for (int j = 0; j < width; j++) out[j] += w * row[j];
+        }
+        for (int j = 0; j < width; j++) out[j] /= area;
+    }
+}
+
+// Vérifier qu'un facteur de réduction est utilisable
+void resample_check_factor(double factor) {
+    if (!(factor >= 1.)) log_fatal("Erreur de redimensionnement : facteur de réduction invalide (%.3f)", factor);
+}
+
+// Réduire des lignes de pixels (la destination doit être allouée)
+void resample_run(resample_t* r) {
+    r->col_spans = resample_spans(r->new_cols, r->factor, r->cols);
+    r->row_spans = resample_spans(r->new_rows, r->factor, r->rows);
+    r->temp = (double*) malloc(sizeof(double) * r->rows * r->new_cols * r->out_channels);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, r->new_rows + 4);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (long long) sizeof(double) * r->out_channels * r->new_cols
+                                                   * (r->rows + r->new_rows));
+
+    parallel_for(r->rows, resample_horizontal, r);
+    parallel_for(r->new_rows, resample_vertical, r);
+
+    free(r->temp);
+    free(r->col_spans);
+    free(r->row_spans);
+}
+
+// Réduire une image en niveaux de gris par moyenne des surfaces
+image_t image_resample(image_t image, double factor) {
+    log_debug("Réduction de l'image : %s avec un facteur de %.3f", image.name, factor);
+    resample_check_factor(factor);
+    int new_rows = (int) (image.rows / factor);
+    int new_cols = (int) (image.cols / factor);
+    image_t scaled = {
+        .name = image.name,
+        .rows = new_rows,
+        .cols = new_cols,
+        .pixels = (pixel_t**) malloc(sizeof(pixel_t*) * new_rows),
+    };
+    for (int i = 0; i < new_rows; i++) {
+        scaled.pixels[i] = (pixel_t*) malloc(sizeof(pixel_t) * new_cols);
+    }
+
+    resample_t r = {
+        .rows = image.rows,
+        .cols = image.cols,
+        .new_rows = new_rows,
+        .new_cols = new_cols,
+        .in_channels = 1,
+        .out_channels = 1,
+        .to_grey = false,
+        .factor = factor,
+        .source = image.pixels,
+        .target = scaled.pixels,
+    };
+    resample_run(&r);
+
+    log_debug("Image réduite : %s avec un facteur de %.3f", image.name, factor);
+    return scaled;
+}
+
+// Réduire une image colorée par moyenne des surfaces
+colored_image_t colored_image_resample(colored_image_t image, double factor) {
+    log_debug("Réduction de l'image colorée : %s avec un facteur de %.3f", image.name, factor);
+    resample_check_factor(factor);
+    int new_rows = (int) (image.rows / factor);
+    int new_cols = (int) (image.cols / factor);
+    colored_image_t scaled = {
+        .name = image.name,
+        .rows = new_rows,
+        .cols = new_cols,
+        .pixels = (colored_pixel_t**) malloc(sizeof(colored_pixel_t*) * new_rows),
+    };
+    for (int i = 0; i < new_rows; i++) {
+        scaled.pixels[i] = (colored_pixel_t*) malloc(sizeof(colored_pixel_t) * new_cols);
+    }
+
+    // Un colored_pixel_t est vu comme trois double consécutifs (r, g, b)
+    resample_t r = {
+        .rows = image.rows,
+        .cols = image.cols,
+        .new_rows = new_rows,
+        .new_cols = new_cols,
+        .in_channels = 3,
+        .out_channels = 3,
+        .to_grey = false,
+        .factor = factor,
+        .source = (double**) image.pixels,
+        .target = (double**) scaled.pixels,
+    };
+    resample_run(&r);
+
+    log_debug("Image colorée réduite : %s avec un facteur de %.3f", image.name, factor);
+    return scaled;
+}
+
+// Convertir une image colorée en niveaux de gris en la réduisant (une seule passe sur l'originale)
+image_t image_from_colored_image_resampled(colored_image_t colored_image, double factor) {
+    log_debug("Conversion et réduction de l'image : %s avec un facteur de %.3f", colored_image.name, factor);
+    resample_check_factor(factor);
+    INSTR_SCOPE(INSTR_STAGE_GREY);
+    int new_rows = (int) (colored_image.rows / factor);
+    int new_cols = (int) (colored_image.cols / factor);
+    image_t scaled = {
+        .name = colored_image.name,
+        .rows = new_rows,
+        .cols = new_cols,
+        .pixels = (pixel_t**) malloc(sizeof(pixel_t*) * new_rows),
+    };
+    for (int i = 0; i < new_rows; i++) {
+        scaled.pixels[i] = (pixel_t*) malloc(sizeof(pixel_t) * new_cols);
+    }
+
+    resample_t r = {
+        .rows = colored_image.rows,
+        .cols = colored_image.cols,
+        .new_rows = new_rows,
+        .new_cols = new_cols,
+        .in_channels = 3,
+        .out_channels = 1,
+        .to_grey = true,
+        .factor = factor,
+        .source = (double**) colored_image.pixels,
+        .target = scaled.pixels,
+    };
+    resample_run(&r);
+
+    log_debug("Conversion et réduction réussies : %s", colored_image.name);
+    return scaled;
+}
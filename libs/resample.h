@@ -0,0 +1,15 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include "image.h"
+
+// Réduire une image en niveaux de gris par moyenne des surfaces (facteur réel >= 1)
+image_t image_resample(image_t image, double factor);
+
+// Réduire une image colorée par moyenne des surfaces (facteur réel >= 1)
+colored_image_t colored_image_resample(colored_image_t image, double factor);
+
+// Convertir une image colorée en niveaux de gris en la réduisant (une seule passe sur l'originale)
+image_t image_from_colored_image_resampled(colored_image_t colored_image, double factor);
+
+#endif // RESAMPLE_H
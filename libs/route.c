@@ -0,0 +1,59 @@
+#include <stdio.h>
+
+#include "route.h"
+#include "crowd.h"
+#include "movement_list.h"
+#include "pyramid.h"
+#include "timed.h"
+#include "equilibrium.h"
+#include "planner.h"
+
+// Mode de routage de la configuration courante
+int route_mode() {
+    if (PYRAMID_LEVELS > 1) return ROUTE_PYRAMID;
+    if (TIME_WINDOW > 0) return ROUTE_TIMED;
+    if (EQUILIBRIUM_ITERATIONS > 0) return ROUTE_EQUILIBRIUM;
+    if (PLANNER) return ROUTE_PLANNED;
+    return ROUTE_ITERATIVE;
+}
+
+// Nom du mode de routage de la configuration courante, pour les journaux
+void route_mode_name(char* name, int size, int modulo) {
+    switch (route_mode()) {
+        case ROUTE_PYRAMID:
+            snprintf(name, size, "A* multi-résolution (%d niveaux)", PYRAMID_LEVELS);
+            break;
+        case ROUTE_TIMED:
+            snprintf(name, size, "A* temporel (fenêtre %d)", TIME_WINDOW);
+            break;
+        case ROUTE_EQUILIBRIUM:
+            snprintf(name, size, "Affectation à l'équilibre");
+            break;
+        case ROUTE_PLANNED:
+            snprintf(name, size, "A* planifié modulo %d", modulo);
+            break;
+        default:
+            snprintf(name, size, "A* modulo %d", modulo);
+    }
+}
+
+// Router des mouvements avec le mode de la configuration (mouvements fusionnés d'abord avec PLANNER)
+void multiple_move_env_route(movement_list_t* movements, environment_t* env, int weight0, int alpha, int modulo) {
+    if (PLANNER) planner_plan(movements);
+    switch (route_mode()) {
+        case ROUTE_PYRAMID:
+            multiple_move_env_pyramid_a_star(movements, env, weight0, alpha, PYRAMID_LEVELS);
+            break;
+        case ROUTE_TIMED:
+            multiple_move_env_timed_a_star(movements, env, weight0, alpha);
+            break;
+        case ROUTE_EQUILIBRIUM:
+            multiple_move_env_equilibrium(movements, env, weight0, alpha);
+            break;
+        case ROUTE_PLANNED:
+            multiple_move_env_planned_a_star(movements, env, weight0, alpha, modulo);
+            break;
+        default:
+            multiple_move_env_iterative_a_star(movements, env, weight0, alpha, modulo);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include "crowd.h"
+#include "movement_list.h"
+
+// Modes de routage, choisis par la configuration dans cet ordre de priorité
+enum route_mode_e {
+    ROUTE_PYRAMID,          // PYRAMID_LEVELS > 1
+    ROUTE_TIMED,            // TIME_WINDOW > 0
+    ROUTE_EQUILIBRIUM,      // EQUILIBRIUM_ITERATIONS > 0
+    ROUTE_PLANNED,          // PLANNER
+    ROUTE_ITERATIVE,        // A* itératif (par défaut)
+};
+
+// Mode de routage de la configuration courante
+int route_mode();
+
+// Nom du mode de routage de la configuration courante, pour les journaux
+void route_mode_name(char* name, int size, int modulo);
+
+// Router des mouvements avec le mode de la configuration (mouvements fusionnés d'abord avec PLANNER).
+// modulo n'est utilisé que par les modes A* itératif et planifié
+void multiple_move_env_route(movement_list_t* movements, environment_t* env, int weight0, int alpha, int modulo);
+
+#endif
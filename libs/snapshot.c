@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <opencv2/opencv.hpp>
+
+#include "snapshot.h"
+#include "render.h"
+#include "resample.h"
+#include "crowd.h"
+#include "logging.h"
+
+int SNAPSHOT_INTERVAL = 0; // Pas de progression par défaut
+int SNAPSHOT_SECONDS = 0;
+int SNAPSHOT_VIDEO = 0;
+int SNAPSHOT_REDUCED = 0;
+
+#define SNAPSHOT_FPS 10
+
+// Fil d'encodage et ses deux tampons : le routage recopie la congestion dans le tampon en attente, le fil
+// l'échange avec le sien avant de l'encoder, si bien que le routage n'attend jamais l'encodage
+struct snapshot_encoder_s {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;
+    bool stopping;
+    bool pending;               // Une image attend d'être encodée
+    environment_t waiting;      // Tampon rempli par le routage
+    environment_t encoding;     // Tampon lu par le fil d'encodage
+    colored_image_t image;      // Réduite à une case par pixel avec SNAPSHOT_REDUCED (à libérer)
+    bool reduced;
+    int n;
+    cv::VideoWriter* video;     // Ouverte à la première image (NULL pour une suite d'images)
+    int frames;
+    int replaced;               // Images remplacées avant d'avoir été encodées
+    long long agents;
+    long long captured;         // Agents routés lors de la dernière image
+    double last;                // Instant de la dernière image (secondes)
+};
+typedef struct snapshot_encoder_s snapshot_encoder_t;
+
+snapshot_encoder_t* snapshot_encoder = NULL;
+
+// Horloge monotone en secondes
+double snapshot_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Encoder une image de la progression
+void snapshot_encode(snapshot_encoder_t* encoder) {
+    cv::Mat frame = render_colored(encoder->image, encoder->encoding, encoder->n);
+    if (encoder->video != NULL) {
+        if (!encoder->video->isOpened()) {
+            encoder->video->open(SNAPSHOT_VIDEO_OUTPUT, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), SNAPSHOT_FPS,
+                                 cv::Size(frame.cols, frame.rows), true);
+            if (!encoder->video->isOpened()) log_error("Erreur lors de l'ouverture de %s", SNAPSHOT_VIDEO_OUTPUT);
+        }
+        if (encoder->video->isOpened()) encoder->video->write(frame);
+    }
+    else {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/frame_%05d.png", SNAPSHOT_DIRECTORY, encoder->frames);
+        cv::imwrite(path, frame);
+    }
+    encoder->frames++;
+}
+
+// Fil d'encodage
+void* snapshot_run(void* arg) {
+    snapshot_encoder_t* encoder = (snapshot_encoder_t*) arg;
+    pthread_mutex_lock(&encoder->mutex);
+    while (true) {
+        while (!encoder->pending && !encoder->stopping) {
+            pthread_cond_wait(&encoder->ready, &encoder->mutex);
+        }
+        if (!encoder->pending && encoder->stopping) break;
+
+        environment_t swap = encoder->encoding;
+        encoder->encoding = encoder->waiting;
+        encoder->waiting = swap;
+        encoder->pending = false;
+
+        pthread_mutex_unlock(&encoder->mutex);
+        snapshot_encode(encoder);
+        pthread_mutex_lock(&encoder->mutex);
+    }
+    pthread_mutex_unlock(&encoder->mutex);
+    return NULL;
+}
+
+// Confier l'état courant de la congestion au fil d'encodage
+void snapshot_capture(snapshot_encoder_t* encoder, environment_t* env) {
+    pthread_mutex_lock(&encoder->mutex);
+    if (encoder->pending) encoder->replaced++;
+    env_copy_into(&encoder->waiting, *env);
+    encoder->pending = true;
+    pthread_cond_signal(&encoder->ready);
+    pthread_mutex_unlock(&encoder->mutex);
+    encoder->captured = encoder->agents;
+    encoder->last = snapshot_now();
+}
+
+// Appelée après chaque agent routé
+void snapshot_agent_hook(const routing_state_t* state, environment_t* env, void* data) {
+    snapshot_encoder_t* encoder = (snapshot_encoder_t*) data;
+    encoder->agents++;
+    if ((SNAPSHOT_INTERVAL > 0 && encoder->agents % SNAPSHOT_INTERVAL == 0)
+            || (SNAPSHOT_SECONDS > 0 && snapshot_now() - encoder->last >= SNAPSHOT_SECONDS)) {
+        snapshot_capture(encoder, env);
+    }
+}
+
+// Démarrer l'écriture de la progression du routage itératif d'un environnement, rendue sur image
+// (chaque case couvrant n x n pixels) par un fil dédié
+void snapshot_start(colored_image_t image, environment_t* env, int n) {
+    if (snapshot_encoder != NULL || (SNAPSHOT_INTERVAL <= 0 && SNAPSHOT_SECONDS <= 0)) return;
+    if (!SNAPSHOT_VIDEO && mkdir(SNAPSHOT_DIRECTORY, 0755) != 0 && errno != EEXIST) {
+        log_error("Erreur lors de la création du dossier %s", SNAPSHOT_DIRECTORY);
+        return;
+    }
+    snapshot_encoder_t* encoder = (snapshot_encoder_t*) malloc(sizeof(snapshot_encoder_t));
+    pthread_mutex_init(&encoder->mutex, NULL);
+    pthread_cond_init(&encoder->ready, NULL);
+    encoder->stopping = false;
+    encoder->pending = false;
+    encoder->waiting = env_alloc(env->rows, env->cols);
+    encoder->encoding = env_alloc(env->rows, env->cols);
+    // Images de la taille de l'environnement : moins de pixels à rendre et à encoder à chaque image
+    encoder->reduced = SNAPSHOT_REDUCED && n > 1;
+    encoder->image = encoder->reduced ? colored_image_resample(image, n) : image;
+    encoder->n = encoder->reduced ? 1 : n;
+    encoder->video = SNAPSHOT_VIDEO ? new cv::VideoWriter() : NULL;
+    encoder->frames = 0;
+    encoder->replaced = 0;
+    encoder->agents = 0;
+    encoder->captured = -1;
+    encoder->last = snapshot_now();
+    pthread_create(&encoder->thread, NULL, snapshot_run, encoder);
+    snapshot_encoder = encoder;
+    crowd_add_agent_hook(snapshot_agent_hook, encoder);
+    log_debug("Progression écrite tous les %d agents ou toutes les %d secondes", SNAPSHOT_INTERVAL,
+              SNAPSHOT_SECONDS);
+}
+
+// Ecrire l'état final puis arrêter l'écriture de la progression
+void snapshot_stop(environment_t* env) {
+    snapshot_encoder_t* encoder = snapshot_encoder;
+    if (encoder == NULL) return;
+    if (encoder->captured != encoder->agents) snapshot_capture(encoder, env);
+
+    pthread_mutex_lock(&encoder->mutex);
+    encoder->stopping = true;
+    pthread_cond_signal(&encoder->ready);
+    pthread_mutex_unlock(&encoder->mutex);
+    pthread_join(encoder->thread, NULL);
+    crowd_remove_agent_hook(snapshot_agent_hook, encoder);
+
+    if (encoder->video != NULL) {
+        encoder->video->release();
+        delete encoder->video;
+    }
+    log_info("Progression : %d images écrites dans %s (%d remplacées avant encodage)", encoder->frames,
+             SNAPSHOT_VIDEO ? SNAPSHOT_VIDEO_OUTPUT : SNAPSHOT_DIRECTORY, encoder->replaced);
+    snapshot_encoder = NULL;
+    pthread_mutex_destroy(&encoder->mutex);
+    pthread_cond_destroy(&encoder->ready);
+    env_free(encoder->waiting);
+    env_free(encoder->encoding);
+    if (encoder->reduced) colored_image_free(encoder->image);
+    free(encoder);
+}
@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "image.h"
+#include "crowd.h"
+
+// Nombre d'agents routés entre deux images de la progression (0 = désactivé)
+extern int SNAPSHOT_INTERVAL;
+
+// Secondes entre deux images de la progression (0 = désactivé)
+extern int SNAPSHOT_SECONDS;
+
+// 1 pour une vidéo unique plutôt qu'une suite d'images PNG
+extern int SNAPSHOT_VIDEO;
+
+// 1 pour rendre la progression à la taille de l'environnement (un pixel par case) plutôt qu'à celle de l'image
+extern int SNAPSHOT_REDUCED;
+
+// Dossier des images de la progression et fichier vidéo
+#define SNAPSHOT_DIRECTORY "pictures/progression"
+#define SNAPSHOT_VIDEO_OUTPUT "pictures/progression.avi"
+
+// Démarrer l'écriture de la progression du routage itératif d'un environnement, rendue sur image
+// (chaque case couvrant n x n pixels) par un fil dédié
+void snapshot_start(colored_image_t image, environment_t* env, int n);
+
+// Ecrire l'état final puis arrêter l'écriture de la progression
+void snapshot_stop(environment_t* env);
+
+#endif
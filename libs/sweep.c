@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "sweep.h"
+#include "crowd.h"
+#include "csv.h"
+#include "route.h"
+#include "parallel.h"
+#include "logging.h"
+#include "common.h"
+
+// Une combinaison de paramètres et son résultat
+struct sweep_result_s {
+    int weight0;
+    int alpha;
+    int modulo;
+    double time;          // Temps réel du routage (secondes)
+    double cpu_time;      // Temps processeur du fil ayant routé
+    int max;              // Congestion maximale
+    int cells;            // Cases empruntées par au moins un agent
+    long long total;      // Somme des congestions
+};
+typedef struct sweep_result_s sweep_result_t;
+
+// Données partagées par les fils du balayage
+struct sweep_task_s {
+    environment_t env;
+    movement_list_t* movements;
+    sweep_result_t* results;
+    int count;
+    int next;             // Prochaine combinaison à traiter (partagée)
+};
+typedef struct sweep_task_s sweep_task_t;
+
+// Ajouter une valeur à une liste
+void sweep_values_add(sweep_values_t* values, int value, int* capacity) {
+    if (values->count == *capacity) {
+        *capacity *= 2;
+        values->values = (int*) realloc(values->values, sizeof(int) * *capacity);
+    }
+    values->values[values->count++] = value;
+}
+
+// Lire une liste de valeurs : "1,2,5", "1:10" ou "1:10:2" (début:fin:pas), éventuellement combinés ("1,4:8:2")
+bool sweep_parse_values(const char* text, sweep_values_t* values) {
+    int capacity = 8;
+    values->count = 0;
+    values->values = (int*) malloc(sizeof(int) * capacity);
+
+    const char* item = text;
+    while (*item != '\0') {
+        int first, last, step = 1, length;
+        if (sscanf(item, "%d:%d:%d%n", &first, &last, &step, &length) == 3
+                || sscanf(item, "%d:%d%n", &first, &last, &length) == 2) {
+            if (step <= 0 || last < first) break;
+            for (int v = first; v <= last; v += step) sweep_values_add(values, v, &capacity);
+        }
+        else if (sscanf(item, "%d%n", &first, &length) == 1) {
+            sweep_values_add(values, first, &capacity);
+        }
+        else break;
+
+        item += length;
+        if (*item == ',') item++;
+        else if (*item != '\0') break;
+    }
+
+    if (*item != '\0' || values->count == 0) {
+        sweep_values_free(*values);
+        values->count = 0;
+        values->values = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Libérer une liste de valeurs
+void sweep_values_free(sweep_values_t values) {
+    free(values.values);
+}
+
+// Horloge en secondes
+double sweep_clock(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Traiter des combinaisons jusqu'à épuisement ; chaque fil garde son environnement de travail et ses tableaux
+void sweep_worker(int start, int end, void* data) {
+    (void) start;
+    (void) end;
+    sweep_task_t* task = (sweep_task_t*) data;
+    environment_t env = env_alloc(task->env.rows, task->env.cols);
+    env_initialiser_tableaux(&env);
+    bool fresh = true;
+
+    int c;
+    while ((c = __atomic_fetch_add(&task->next, 1, __ATOMIC_RELAXED)) < task->count) {
+        sweep_result_t* result = &task->results[c];
+        log_debug("Balayage : weight0 = %d, alpha = %d, modulo = %d", result->weight0, result->alpha, result->modulo);
+
+        // Etat initial : une seule copie de l'environnement d'origine
+        env_copy_into(&env, task->env);
+        if (!fresh) env_reinitialiser_tableaux(&env);
+        fresh = false;
+        movement_list_t* movements = ml_copy(task->movements);
+
+        double wall_start = sweep_clock(CLOCK_MONOTONIC);
+        double cpu_start = sweep_clock(CLOCK_THREAD_CPUTIME_ID);
+        multiple_move_env_route(movements, &env, result->weight0, result->alpha, result->modulo);
+        result->time = sweep_clock(CLOCK_MONOTONIC) - wall_start;
+        result->cpu_time = sweep_clock(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+        free_movements(movements);
+
+        // Statistiques de congestion
+        result->max = env.max;
+        result->cells = 0;
+        result->total = 0;
+        int* cells = env.agents[0];
+        for (int k = 0; k < env.rows * env.cols; k++) {
+            if (cells[k] > 0) {
+                result->cells++;
+                result->total += cells[k];
+            }
+        }
+    }
+
+    env_liberer_tableaux(&env);
+    env_free(env);
+}
+
+// Router les mouvements pour chaque combinaison (weight0, alpha, modulo) à partir du même environnement
+// et écrire un tableau des temps et des statistiques de congestion dans output
+void sweep_run(environment_t env, movement_list_t* movements, sweep_values_t weight0s, sweep_values_t alphas,
+               sweep_values_t modulos, const char* output) {
+    int capacity = weight0s.count * alphas.count * modulos.count;
+    sweep_task_t task = {
+        .env = env,
+        .movements = movements,
+        .results = (sweep_result_t*) calloc(capacity, sizeof(sweep_result_t)),
+        .count = 0,
+        .next = 0
+    };
+    for (int w = 0; w < weight0s.count; w++) {
+        for (int a = 0; a < alphas.count; a++) {
+            for (int m = 0; m < modulos.count; m++) {
+                int weight0 = weight0s.values[w];
+                int alpha = alphas.values[a];
+                int modulo = modulos.values[m];
+                if (weight0 < 0 || alpha < 0 || (weight0 == 0 && alpha == 0) || modulo <= 0) {
+                    log_warning("Combinaison ignorée : weight0 = %d, alpha = %d, modulo = %d", weight0, alpha, modulo);
+                    continue;
+                }
+                task.results[task.count++] = (sweep_result_t) {.weight0 = weight0, .alpha = alpha, .modulo = modulo};
+            }
+        }
+    }
+    int threads = parallel_threads();
+    if (threads > task.count) threads = task.count;
+    log_info("Balayage de %d combinaisons sur %d fils", task.count, threads);
+
+    // Chaque fil prend la combinaison suivante dès qu'il a terminé la sienne
+    double start = sweep_clock(CLOCK_MONOTONIC);
+    parallel_for(threads, sweep_worker, &task);
+    log_info("Balayage terminé en %.3f secondes", sweep_clock(CLOCK_MONOTONIC) - start);
+
+    FILE* file = fopen(output, "w");
+    if (file == NULL) log_fatal("Erreur lors de l'ouverture du fichier de résultats : %s", output);
+    fprintf(file, "weight0;alpha;modulo;temps_secondes;cpu_secondes;max;cellules;moyenne;total\n");
+    for (int c = 0; c < task.count; c++) {
+        sweep_result_t* r = &task.results[c];
+        fprintf(file, "%d;%d;%d;%.6f;%.6f;%d;%d;%.3f;%lld\n", r->weight0, r->alpha, r->modulo, r->time,
+                r->cpu_time, r->max, r->cells, r->cells > 0 ? (double) r->total / r->cells : 0., r->total);
+    }
+    fclose(file);
+    log_info("Résultats du balayage écrits dans %s", output);
+    free(task.results);
+}
@@ -0,0 +1,27 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdbool.h>
+
+#include "crowd.h"
+#include "movement_list.h"
+
+// Valeurs prises par un paramètre du balayage
+struct sweep_values_s {
+    int count;
+    int* values;
+};
+typedef struct sweep_values_s sweep_values_t;
+
+// Lire une liste de valeurs : "1,2,5", "1:10" ou "1:10:2" (début:fin:pas), éventuellement combinés ("1,4:8:2")
+bool sweep_parse_values(const char* text, sweep_values_t* values);
+
+// Libérer une liste de valeurs
+void sweep_values_free(sweep_values_t values);
+
+// Router les mouvements pour chaque combinaison (weight0, alpha, modulo) à partir du même environnement
+// et écrire un tableau des temps et des statistiques de congestion dans output
+void sweep_run(environment_t env, movement_list_t* movements, sweep_values_t weight0s, sweep_values_t alphas,
+               sweep_values_t modulos, const char* output);
+
+#endif
@@ -0,0 +1,302 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "timed.h"
+#include "crowd.h"
+#include "occupancy.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "logging.h"
+#include "common.h"
+#include "instrument.h"
+#include "cost.h"
+
+int TIME_WINDOW = 0; // Routage temporel désactivé par défaut
+int TIME_BUCKET = 4;
+int TIME_SPACING = 1;
+
+// Préparer le routage temporel sur un environnement
+timed_t timed_create(environment_t* env) {
+    int size = env->rows * env->cols;
+    timed_t timed = {
+        .env = env,
+        .occupancy = occupancy_create(1024),
+        .steps = (int*) malloc(sizeof(int) * size),
+        .next = (int*) malloc(sizeof(int) * size),
+        .sources = (int*) malloc(sizeof(int) * size),
+        .source_count = 0,
+        .box_i = 0,
+        .box_j = 0,
+        .box_rows = 0,
+        .box_cols = 0,
+        .capacity = 0,
+        .g = NULL,
+        .pred = NULL,
+        .seen = NULL,
+        .closed = NULL,
+        .ids = NULL,
+        .epoch = 0,
+        .path = (int*) malloc(sizeof(int) * (TIME_WINDOW + 1)),
+        .path_len = 0,
+        .arrived = false,
+        .expanded = 0,
+        .waits = 0
+    };
+    return timed;
+}
+
+// Libérer les tableaux du routage temporel (l'environnement est conservé)
+void timed_free(timed_t* timed) {
+    occupancy_free(timed->occupancy);
+    free(timed->steps);
+    free(timed->next);
+    free(timed->sources);
+    free(timed->g);
+    free(timed->pred);
+    free(timed->seen);
+    free(timed->closed);
+    free(timed->ids);
+    free(timed->path);
+}
+
+// Parcours en largeur depuis la zone d'arrivée : nombre de pas sans congestion et case suivante vers la zone
+void timed_prepare(timed_t* timed, movement_t movement) {
+    environment_t* env = timed->env;
+    int size = env->rows * env->cols;
+    for (int c = 0; c < size; c++) timed->steps[c] = -1;
+
+    // La file du parcours réutilise le tableau des sources, vide entre deux mouvements
+    int* queue = timed->sources;
+    int head = 0;
+    int tail = 0;
+    region_cells_t cells = region_cells(movement.target, movement.target_span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        int c = p.i * env->cols + p.j;
+        timed->steps[c] = 0;
+        timed->next[c] = c;
+        queue[tail++] = c;
+    }
+    while (head < tail) {
+        int c = queue[head++];
+        int ci = c / env->cols;
+        int cj = c % env->cols;
+        for (int d = 0; d < CONNECTIVITY; d++) {
+            if (!env_can_move(env, ci, cj, d)) continue;
+            int ni = ci + directions[d][0];
+            int nj = cj + directions[d][1];
+            int n = ni * env->cols + nj;
+            if (timed->steps[n] != -1) continue;
+            timed->steps[n] = timed->steps[c] + 1;
+            timed->next[n] = c;
+            queue[tail++] = n;
+        }
+    }
+    timed->source_count = 0;
+}
+
+// Adapter la boîte des états de la fenêtre aux sources courantes
+void timed_box(timed_t* timed) {
+    environment_t* env = timed->env;
+    int min_i = env->rows, max_i = -1, min_j = env->cols, max_j = -1;
+    for (int k = 0; k < timed->source_count; k++) {
+        int i = timed->sources[k] / env->cols;
+        int j = timed->sources[k] % env->cols;
+        if (i < min_i) min_i = i;
+        if (i > max_i) max_i = i;
+        if (j < min_j) min_j = j;
+        if (j > max_j) max_j = j;
+    }
+    // Un agent ne fait pas plus de TIME_WINDOW pas dans la fenêtre
+    timed->box_i = (min_i - TIME_WINDOW > 0) ? min_i - TIME_WINDOW : 0;
+    timed->box_j = (min_j - TIME_WINDOW > 0) ? min_j - TIME_WINDOW : 0;
+    timed->box_rows = ((max_i + TIME_WINDOW < env->rows) ? max_i + TIME_WINDOW : env->rows - 1) - timed->box_i + 1;
+    timed->box_cols = ((max_j + TIME_WINDOW < env->cols) ? max_j + TIME_WINDOW : env->cols - 1) - timed->box_j + 1;
+
+    int states = timed->box_rows * timed->box_cols * (TIME_WINDOW + 1);
+    if (states <= timed->capacity) return;
+    free(timed->g);
+    free(timed->pred);
+    free(timed->seen);
+    free(timed->closed);
+    free(timed->ids);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATIONS, 5);
+    INSTR_COUNT(INSTR_COUNTER_ALLOCATED_BYTES, (sizeof(double) + 4 * sizeof(int)) * states);
+    timed->g = (double*) malloc(sizeof(double) * states);
+    timed->pred = (int*) malloc(sizeof(int) * states);
+    timed->seen = (int*) calloc(states, sizeof(int));
+    timed->closed = (int*) calloc(states, sizeof(int));
+    timed->ids = (int*) malloc(sizeof(int) * states);
+    for (int s = 0; s < states; s++) timed->ids[s] = s;
+    timed->capacity = states;
+}
+
+// A* dans l'espace-temps sur TIME_WINDOW pas à partir des sources, au pas tick ; une case peut être gardée
+// (attente) et son coût dépend de son occupation au créneau d'arrivée. Au bout de la fenêtre, le reste du
+// trajet est estimé sans congestion. Le chemin trouvé est gardé dans timed->path
+bool timed_search(timed_t* timed, priority_queue_t* pq, movement_t* movement, long long tick,
+                  cost_table_t* costs) {
+    environment_t* env = timed->env;
+    timed_box(timed);
+    int epoch = ++timed->epoch;
+    int layer = timed->box_rows * timed->box_cols;
+
+    pq_clear(pq);
+    for (int k = 0; k < timed->source_count; k++) {
+        int c = timed->sources[k];
+        if (timed->steps[c] == -1) continue;
+        int s = (c / env->cols - timed->box_i) * timed->box_cols + (c % env->cols - timed->box_j);
+        timed->g[s] = 0.;
+        timed->pred[s] = -1;
+        timed->seen[s] = epoch;
+        pq_push(pq, costs->lower * timed->steps[c], (void*) &timed->ids[s]);
+    }
+
+    int end = -1;
+    while (!pq_is_empty(pq)) {
+        int s = *(int*) pq_pop(pq);
+        if (timed->closed[s] == epoch) continue;
+        timed->closed[s] = epoch;
+        timed->expanded++;
+        INSTR_COUNT(INSTR_COUNTER_EXPANDED, 1);
+
+        int dt = s / layer;
+        int i = (s % layer) / timed->box_cols + timed->box_i;
+        int j = (s % layer) % timed->box_cols + timed->box_j;
+        timed->arrived = region_contains(movement->target, movement->target_span, i, j);
+        if (timed->arrived || dt == TIME_WINDOW) {
+            end = s;
+            break;
+        }
+
+        int bucket = (int) ((tick + dt + 1) / TIME_BUCKET);
+        // Les déplacements puis l'attente sur place (d == CONNECTIVITY)
+        for (int d = 0; d <= CONNECTIVITY; d++) {
+            bool wait = d == CONNECTIVITY;
+            if (!wait && !env_can_move(env, i, j, d)) continue;
+            if (wait && env->agents[i][j] == -1) continue;
+            int ni = wait ? i : i + directions[d][0];
+            int nj = wait ? j : j + directions[d][1];
+            int n = ni * env->cols + nj;
+            if (timed->steps[n] == -1) continue;
+            int ns = (dt + 1) * layer + (ni - timed->box_i) * timed->box_cols + (nj - timed->box_j);
+            if (timed->closed[ns] == epoch) continue;
+
+            double length = wait ? 1. : direction_lengths[d];
+            double new_dist = timed->g[s] + cost_get(costs, occupancy_get(timed->occupancy, n, bucket)) * length;
+            if (timed->seen[ns] != epoch || new_dist < timed->g[ns]) {
+                timed->seen[ns] = epoch;
+                timed->g[ns] = new_dist;
+                timed->pred[ns] = s;
+                // Chaque pas coûte au moins le plus petit coût d'une case : le nombre de pas sans congestion
+                // reste minorant
+                pq_push(pq, new_dist + costs->lower * timed->steps[n], (void*) &timed->ids[ns]);
+            }
+        }
+    }
+    if (end == -1) return false;
+
+    // Chemin des sources vers la fin de la fenêtre, une case par pas
+    timed->path_len = end / layer + 1;
+    for (int s = end, k = timed->path_len - 1; s != -1; s = timed->pred[s], k--) {
+        int i = (s % layer) / timed->box_cols + timed->box_i;
+        int j = (s % layer) % timed->box_cols + timed->box_j;
+        timed->path[k] = i * env->cols + j;
+    }
+    return true;
+}
+
+// Occuper une case au pas tick ; la congestion de l'environnement ne compte qu'une fois une attente sur place
+void timed_occupy(timed_t* timed, int cell, long long tick, int* previous) {
+    environment_t* env = timed->env;
+    occupancy_add(timed->occupancy, cell, (int) (tick / TIME_BUCKET));
+    INSTR_COUNT(INSTR_COUNTER_PATH_CELLS, 1);
+    if (cell == *previous) {
+        timed->waits++;
+        return;
+    }
+    *previous = cell;
+    int value = ++env->agents[cell / env->cols][cell % env->cols];
+    if (value > env->max) env->max = value;
+}
+
+// Router un agent parti au pas tick, une fenêtre après l'autre ; seule la première moitié de chaque fenêtre
+// est gardée avant de recalculer la suite. Renvoie false si la zone d'arrivée est inaccessible
+bool timed_route(timed_t* timed, priority_queue_t* pq, movement_t* movement, long long tick, cost_table_t* costs) {
+    environment_t* env = timed->env;
+    timed->source_count = 0;
+    region_cells_t cells = region_cells(movement->start, movement->start_span, env->rows, env->cols);
+    position_t p;
+    while (region_cells_next(&cells, env->agents, &p)) {
+        timed->sources[timed->source_count++] = p.i * env->cols + p.j;
+    }
+    if (timed->source_count == 0) return false;
+
+    int previous = -1;
+    int keep = (TIME_WINDOW / 2 > 0) ? TIME_WINDOW / 2 : 1;
+    // Garde-fou contre une attente sans fin : au-delà, l'agent finit sans tenir compte de la congestion
+    long long limit = tick + 4LL * env->rows * env->cols;
+    INSTR_COUNT(INSTR_COUNTER_PATHS, 1);
+    while (true) {
+        if (!timed_search(timed, pq, movement, tick, costs)) return false;
+        if (previous == -1) timed_occupy(timed, timed->path[0], tick, &previous);
+        int steps = timed->arrived ? timed->path_len - 1 : keep;
+        for (int k = 1; k <= steps; k++) {
+            timed_occupy(timed, timed->path[k], tick + k, &previous);
+        }
+        tick += steps;
+        if (timed->arrived) return true;
+
+        int cell = timed->path[steps];
+        if (tick > limit) {
+            while (timed->steps[cell] > 0) {
+                cell = timed->next[cell];
+                timed_occupy(timed, cell, ++tick, &previous);
+            }
+            return true;
+        }
+        timed->sources[0] = cell;
+        timed->source_count = 1;
+    }
+}
+
+// Déplacer les agents d'un mouvement, partis tous les TIME_SPACING pas à partir de movement.departure
+void timed_move(timed_t* timed, priority_queue_t* pq, movement_t movement, int weight0, int alpha) {
+    log_debug("Déplacement de %d agents avec le routage temporel", movement.agents);
+    INSTR_SCOPE(INSTR_STAGE_MOVEMENT);
+    timed_prepare(timed, movement);
+    cost_table_t costs = cost_table_create(weight0, alpha);
+
+    for (int a = 0; a < movement.agents; a++) {
+        long long tick = movement.departure + (long long) a * TIME_SPACING;
+        if (!timed_route(timed, pq, &movement, tick, &costs)) {
+            log_warning("Aucun chemin de (%d, %d) vers (%d, %d)", movement.start.i, movement.start.j,
+                        movement.target.i, movement.target.j);
+            break;
+        }
+    }
+    cost_table_free(&costs);
+    log_debug("Déplacement des %d agents avec le routage temporel terminé", movement.agents);
+}
+
+// Appliquer plusieurs mouvements à un environnement avec le routage temporel
+void multiple_move_env_timed_a_star(movement_list_t* movements, environment_t* env, int weight0, int alpha) {
+    log_debug("Déplacement d'agents avec le routage temporel, fenêtre de %d pas", TIME_WINDOW);
+    INSTR_SCOPE(INSTR_STAGE_ROUTING);
+    if (TIME_BUCKET < 1) TIME_BUCKET = 1;
+    if (TIME_SPACING < 0) TIME_SPACING = 0;
+    timed_t timed = timed_create(env);
+    priority_queue_t* pq = pq_create(1024);
+
+    while (!ml_is_empty(movements)) {
+        timed_move(&timed, pq, *ml_get(movements), weight0, alpha);
+        ml_remove(movements);
+    }
+    log_info("Routage temporel : %lld états développés, %lld attentes, %d couples (case, créneau) occupés",
+             timed.expanded, timed.waits, timed.occupancy->size);
+
+    pq_free(pq);
+    timed_free(&timed);
+    log_debug("Déplacement d'agents avec le routage temporel terminé");
+}
@@ -0,0 +1,62 @@
+#ifndef TIMED_H
+#define TIMED_H
+
+#include <stdbool.h>
+
+#include "crowd.h"
+#include "occupancy.h"
+#include "priority_queue.h"
+#include "movement_list.h"
+#include "common.h"
+
+// Profondeur en pas de temps de la fenêtre de réservation (0 = routage sans le temps, par défaut)
+extern int TIME_WINDOW;
+
+// Pas de temps par créneau d'occupation
+extern int TIME_BUCKET;
+
+// Pas de temps entre les départs de deux agents d'un même mouvement
+extern int TIME_SPACING;
+
+// Routage dans l'espace-temps : chaque agent est routé par fenêtres de TIME_WINDOW pas, le coût d'une
+// case dépendant du nombre d'agents qui l'occupent pendant le créneau où il y arrive
+struct timed_s {
+    environment_t* env;
+    occupancy_t* occupancy;
+    int* steps;             // Pas jusqu'à la zone d'arrivée du mouvement en cours, sans congestion (-1 : inaccessible)
+    int* next;              // Case suivante vers cette zone
+    int* sources;           // Cases de départ de la fenêtre suivante
+    int source_count;
+    // États (pas, case) de la fenêtre : une boîte autour des sources sur TIME_WINDOW + 1 pas
+    int box_i;
+    int box_j;
+    int box_rows;
+    int box_cols;
+    int capacity;
+    double* g;
+    int* pred;
+    int* seen;              // Dernière recherche ayant atteint l'état
+    int* closed;            // Dernière recherche ayant développé l'état
+    int* ids;               // Valeurs de la file de priorité
+    int epoch;
+    int* path;              // Cases du dernier chemin de la fenêtre, une par pas, des sources à la fin
+    int path_len;
+    bool arrived;           // Le dernier chemin atteint la zone d'arrivée
+    long long expanded;
+    long long waits;
+};
+typedef struct timed_s timed_t;
+
+// Préparer le routage temporel sur un environnement
+timed_t timed_create(environment_t* env);
+
+// Libérer les tableaux du routage temporel (l'environnement est conservé)
+void timed_free(timed_t* timed);
+
+// Déplacer les agents d'un mouvement, partis tous les TIME_SPACING pas à partir de movement.departure
+void timed_move(timed_t* timed, priority_queue_t* pq, movement_t movement, int weight0, int alpha);
+
+// Appliquer plusieurs mouvements à un environnement avec le routage temporel
+void multiple_move_env_timed_a_star(movement_list_t* movements, environment_t* env, int weight0, int alpha);
+
+#endif
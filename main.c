@@ -12,9 +12,23 @@
 #include "logging.h"
 #include "config.h"
 #include "crowd.h"
-#include "circular_list.h"
+#include "movement_list.h"
 #include "common.h"
 #include "csv.h"
+#include "canny_stream.h"
+#include "resample.h"
+#include "pyramid.h"
+#include "batch.h"
+#include "sweep.h"
+#include "checkpoint.h"
+#include "planner.h"
+#include "timed.h"
+#include "render.h"
+#include "snapshot.h"
+#include "congestion.h"
+#include "equilibrium.h"
+#include "heuristic.h"
+#include "route.h"
 
 int main(int argc, char** argv) {
     // Chargement de la configuration
@@ -22,6 +36,169 @@ int main(int argc, char** argv) {
     clock_t start, end;
     double cpu_time_used;
 
+    // Mode par bandes : contours d'une image trop grande pour être chargée en mémoire
+    if (argc >= 2 && strcmp(argv[1], "stream") == 0) {
+        if (argc < 4 || 5 < argc) {
+            log_fatal("Usage : %s stream <image> <sortie.pgm> [lignes-par-bande]", argv[0]);
+        }
+        int strip_rows = (argc == 5) ? atoi(argv[4]) : CANNY_STREAM_STRIP_ROWS;
+        canny_stream(argv[2], argv[3], 0.1, 0.2, 30, strip_rows);
+        log_info("Contours ecrits par bandes dans %s", argv[3]);
+        return 0;
+    }
+
+    // Mode batch : les environnements restent en mémoire d'un travail à l'autre
+    if (argc >= 2 && strcmp(argv[1], "batch") == 0) {
+        if (3 < argc) log_fatal("Usage : %s batch [socket]", argv[0]);
+        if (argc == 3) {
+            batch_serve(argv[2]);
+        }
+        else {
+            batch_start();
+            batch_run(stdin, stdout);
+            batch_stop();
+        }
+        return 0;
+    }
+
+    // Conversion d'un fichier de mouvements au format binaire
+    if (argc >= 2 && strcmp(argv[1], "convert-movements") == 0) {
+        if (argc != 4) log_fatal("Usage : %s convert-movements <movements.csv> <movements.bin>", argv[0]);
+        movement_list_t* movements = load_movements(argv[2], 1);
+        if (movements == NULL) log_fatal("Erreur lors de la lecture des mouvements : %s", argv[2]);
+        if (!save_movements_binary(movements, argv[3])) log_fatal("Erreur lors de l'écriture de %s", argv[3]);
+        log_info("%d mouvements écrits dans %s", ml_remaining(movements), argv[3]);
+        free_movements(movements);
+        return 0;
+    }
+
+    // Lecture d'un fichier de congestion
+    if (argc >= 2 && strcmp(argv[1], "congestion-info") == 0) {
+        if (argc < 3 || 5 < argc) log_fatal("Usage : %s congestion-info <fichier> [cases.csv] [chemins.txt]", argv[0]);
+        FILE* cells = (argc >= 4) ? fopen(argv[3], "w") : NULL;
+        FILE* paths = (argc == 5) ? fopen(argv[4], "w") : NULL;
+        if ((argc >= 4 && cells == NULL) || (argc == 5 && paths == NULL)) log_fatal("Erreur lors de l'ouverture des sorties");
+        congestion_file_t result;
+        if (!congestion_read(argv[2], &result, cells, paths)) log_fatal("Erreur lors de la lecture de %s", argv[2]);
+        long long used = 0;
+        long long cells_count = (long long) result.env.rows * result.env.cols;
+        for (long long c = 0; c < cells_count; c++) used += result.env.agents[0][c] > 0;
+        printf("%d x %d, maximum %d, %lld cases empruntées, %lld chemins (%lld cases), %lld octets\n",
+               result.env.rows, result.env.cols, result.env.max, used, result.paths, result.path_cells, result.size);
+        if (cells != NULL) fclose(cells);
+        if (paths != NULL) fclose(paths);
+        env_free(result.env);
+        return 0;
+    }
+
+    // Balayage de paramètres : un seul prétraitement pour toutes les combinaisons
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0) {
+        if (argc < 7 || 9 < argc) {
+            log_fatal("Usage : %s sweep <image> <movements-file> <weight0s> <alphas> <modulos> [compression] [sortie.csv]",
+                      argv[0]);
+        }
+        sweep_values_t weight0s, alphas, modulos;
+        if (!sweep_parse_values(argv[4], &weight0s)) log_fatal("Valeurs de weight0 invalides : %s", argv[4]);
+        if (!sweep_parse_values(argv[5], &alphas)) log_fatal("Valeurs de alpha invalides : %s", argv[5]);
+        if (!sweep_parse_values(argv[6], &modulos)) log_fatal("Valeurs de modulo invalides : %s", argv[6]);
+        int n = (argc >= 8) ? atoi(argv[7]) : 1;
+        if (n <= 0) log_fatal("Erreur de redimensionnement : facteur de réduction invalide (%d)", n);
+
+        colored_image_t colored_image = image_read(argv[2]);
+        image_t image = (n > 1) ? image_from_colored_image_resampled(colored_image, n)
+                                : image_from_colored_image(colored_image);
+        image_t canny_image = canny(image, 0.1, 0.2);
+        image_t image_morpho = image_fermeture_morphologique(canny_image, 30/n);
+        environment_t env = env_from_image(image_morpho);
+        movement_list_t* movements = load_movements(argv[3], n);
+        if (movements == NULL) log_fatal("Erreur lors de la lecture des mouvements : %s", argv[3]);
+
+        sweep_run(env, movements, weight0s, alphas, modulos, (argc == 9) ? argv[8] : "sweep.csv");
+
+        free_movements(movements);
+        env_free(env);
+        sweep_values_free(weight0s);
+        sweep_values_free(alphas);
+        sweep_values_free(modulos);
+        image_free(image_morpho);
+        image_free(canny_image);
+        image_free(image);
+        colored_image_free(colored_image);
+        return 0;
+    }
+
+    // Comparaison des constructions de l'heuristique sur la congestion d'un routage itératif
+    if (argc >= 2 && strcmp(argv[1], "heuristic-check") == 0) {
+        if (argc < 6 || 7 < argc) {
+            log_fatal("Usage : %s heuristic-check <image> <movements-file> <weight0> <alpha> [compression]", argv[0]);
+        }
+        int weight0 = atoi(argv[4]);
+        int alpha = atoi(argv[5]);
+        if (weight0 < 0 || alpha < 0 || (weight0 == 0 && alpha == 0)) log_fatal("Poids invalides");
+        int n = (argc == 7) ? atoi(argv[6]) : 1;
+        if (n <= 0) log_fatal("Erreur de redimensionnement : facteur de réduction invalide (%d)", n);
+
+        colored_image_t colored_image = image_read(argv[2]);
+        image_t image = (n > 1) ? image_from_colored_image_resampled(colored_image, n)
+                                : image_from_colored_image(colored_image);
+        image_t canny_image = canny(image, 0.1, 0.2);
+        image_t image_morpho = image_fermeture_morphologique(canny_image, 30/n);
+        environment_t env = env_from_image(image_morpho);
+        env_initialiser_tableaux(&env);
+        movement_list_t* movements = load_movements(argv[3], n);
+        if (movements == NULL) log_fatal("Erreur lors de la lecture des mouvements : %s", argv[3]);
+        multiple_move_env_iterative_a_star(movements, &env, weight0, alpha, 10);
+        free_movements(movements);
+
+        movements = load_movements(argv[3], n);
+        heuristic_compare(&env, movements, weight0, alpha);
+
+        free_movements(movements);
+        env_liberer_tableaux(&env);
+        env_free(env);
+        image_free(image_morpho);
+        image_free(canny_image);
+        image_free(image);
+        colored_image_free(colored_image);
+        return 0;
+    }
+
+    // Reprise d'un routage itératif interrompu (ou variante avec d'autres poids)
+    if (argc >= 2 && strcmp(argv[1], "resume") == 0) {
+        if (argc != 4 && argc != 6) log_fatal("Usage : %s resume <image> <point-de-reprise> [weight0 alpha]", argv[0]);
+        checkpoint_t checkpoint = checkpoint_open(argv[3]);
+        int n = checkpoint.header->compression;
+        int weight0 = (argc == 6) ? atoi(argv[4]) : checkpoint.header->weight0;
+        int alpha = (argc == 6) ? atoi(argv[5]) : checkpoint.header->alpha;
+        if (weight0 < 0 || alpha < 0 || (weight0 == 0 && alpha == 0)) log_fatal("Poids invalides");
+
+        colored_image_t colored_image = image_read(argv[2]);
+        environment_t env = checkpoint_environment(&checkpoint);
+        env_initialiser_tableaux(&env);
+        checkpoint_restore_heuristic(&checkpoint);
+        movement_list_t* movements = checkpoint_movements(&checkpoint);
+        log_info("Reprise : %d mouvements restants, %d agents déjà routés pour le premier",
+                 checkpoint.header->movements, checkpoint.header->iteration);
+
+        if (CHECKPOINT_INTERVAL > 0) checkpoint_enable(n);
+        if (CONGESTION_OUTPUT > 0) congestion_open(CONGESTION_OUTPUT_FILE, &env, CONGESTION_OUTPUT > 1);
+        snapshot_start(colored_image, &env, n);
+        multiple_move_env_iterative_a_star_from(movements, &env, weight0, alpha, checkpoint.header->modulo,
+                                                checkpoint.header->iteration);
+        snapshot_stop(&env);
+        congestion_close(&env);
+
+        render_colored_write(colored_image, env, n, "pictures/image_resultat.jpg");
+        log_info("Image resultante ecrite dans pictures/image_resultat.jpg");
+
+        free_movements(movements);
+        env_liberer_tableaux(&env);
+        env_free(env);
+        colored_image_free(colored_image);
+        checkpoint_close(&checkpoint);
+        return 0;
+    }
+
     if (argc < 5 || 6 < argc) {
         log_fatal("Usage : %s <image> <movements-file> <weight0> <alpha> [compression]", argv[0]);
     }
@@ -36,14 +213,17 @@ int main(int argc, char** argv) {
     }
     int n = 1;
 
-    colored_image_t colored_image = image_read(argv[1]);    
-    image_t image = image_from_colored_image(colored_image);
+    colored_image_t colored_image = image_read(argv[1]);
+    image_t image;
 
     if (argc == 6) {
+        // Conversion en niveaux de gris et réduction en une seule passe
         n = atoi(argv[5]);
-        image_t past = image;
-        image = image_resize(image, n);
-        image_free(past);
+        if (n <= 0) log_fatal("Erreur de redimensionnement : facteur de réduction invalide (%d)", n);
+        image = image_from_colored_image_resampled(colored_image, n);
+    }
+    else {
+        image = image_from_colored_image(colored_image);
     }
 
     // Application du filtre de Canny
@@ -58,21 +238,31 @@ int main(int argc, char** argv) {
 
     // Test sur les environnements
     environment_t env;
-    circular_list_t* movements;
+    movement_list_t* movements;
     
     env = env_from_image(image_morpho);
     env_initialiser_tableaux(&env);
     movements = load_movements(movements_file_path, n);
+    if (CONGESTION_OUTPUT > 0) congestion_open(CONGESTION_OUTPUT_FILE, &env, CONGESTION_OUTPUT > 1);
+    snapshot_start(colored_image, &env, n);
+    // Points de reprise du A* itératif seulement (la planification, qui passe aussi par lui, n'en écrit pas)
+    if (CHECKPOINT_INTERVAL > 0) {
+        if (route_mode() == ROUTE_ITERATIVE) checkpoint_enable(n);
+        else log_warning("Les points de reprise ne sont écrits qu'avec le A* itératif");
+    }
+    // Mode de routage effectivement utilisé, pour la mesure du temps
+    char mode[64];
+    route_mode_name(mode, sizeof(mode), 10);
     start = clock();
-    multiple_move_env_iterative_a_star(movements, &env, weight0, alpha, 10);
+    multiple_move_env_route(movements, &env, weight0, alpha, 10);
     end = clock();
     cpu_time_used = ((double) (end-start)) / CLOCKS_PER_SEC;
-    log_info("A* modulo %d : %.3f secondes", 10, cpu_time_used);
+    log_info("%s : %.3f secondes", mode, cpu_time_used);
+    snapshot_stop(&env);
+    congestion_close(&env);
 
-    env_image_edit(image_morpho, env, 1);
-    image_write(image_morpho, "pictures/image_resultat0.jpg");
-    env_image_colored_edit(colored_image, env, n);
-    colored_image_write(colored_image, "pictures/image_resultat.jpg");
+    render_grey_write(image_morpho, env, 1, "pictures/image_resultat0.jpg");
+    render_colored_write(colored_image, env, n, "pictures/image_resultat.jpg");
     log_info("Image resultante ecrite dans pictures/image_resultat.jpg");
 
     free_movements(movements);